@@ -0,0 +1,196 @@
+#include <cstdint>
+#include <vector>
+#include <random>
+#include <stdexcept>
+#include <algorithm>
+
+#include "include/BatchWorld.h"
+#include "include/BitLife.h"
+#include "include/ByteWorld.h"
+
+const long long BatchWorld::max_window;
+
+namespace {
+    // 256 lanes as four words for CPUs without AVX2
+    struct Lanes256 {
+        uint64_t w[4];
+    };
+
+    inline Lanes256 operator&(const Lanes256& a, const Lanes256& b) {
+        return Lanes256{{a.w[0] & b.w[0], a.w[1] & b.w[1], a.w[2] & b.w[2], a.w[3] & b.w[3]}};
+    }
+
+    inline Lanes256 operator|(const Lanes256& a, const Lanes256& b) {
+        return Lanes256{{a.w[0] | b.w[0], a.w[1] | b.w[1], a.w[2] | b.w[2], a.w[3] | b.w[3]}};
+    }
+
+    inline Lanes256 operator^(const Lanes256& a, const Lanes256& b) {
+        return Lanes256{{a.w[0] ^ b.w[0], a.w[1] ^ b.w[1], a.w[2] ^ b.w[2], a.w[3] ^ b.w[3]}};
+    }
+
+    inline Lanes256 operator~(const Lanes256& a) {
+        return Lanes256{{~a.w[0], ~a.w[1], ~a.w[2], ~a.w[3]}};
+    }
+
+    // One generation of all lanes, W holds the lanes of one cell
+    template <class W>
+    void evolve_lanes(const W* in, W* out, int height, int width) {
+        size_t stride = width + 2;
+        // one contiguous band of rows per thread
+        #pragma omp parallel for schedule(static)
+        for (int i = 1; i <= height; i++) {
+            const W* up = in + size_t(i - 1) * stride;
+            const W* mid = up + stride;
+            const W* dn = mid + stride;
+            W* res = out + size_t(i) * stride;
+            for (int j = 1; j <= width; j++) {
+                res[j] = bitlife::life(up[j-1], up[j], up[j+1], mid[j-1], mid[j], mid[j+1], dn[j-1], dn[j], dn[j+1]);
+            }
+        }
+    }
+}
+
+namespace batchlife {
+    void evolve_256(const uint64_t* in, uint64_t* out, int height, int width) {
+        evolve_lanes(reinterpret_cast<const Lanes256*>(in), reinterpret_cast<Lanes256*>(out), height, width);
+    }
+}
+
+BatchWorld::BatchWorld(int height, int width, int lanes): height(height), width(width), lanes(lanes) {
+    if (lanes != 64 && lanes != 256) {
+        throw std::runtime_error("A batch holds 64 or 256 worlds");
+    }
+    groups = lanes / 64;
+    state1.assign(size_t(height + 2) * (width + 2) * groups, 0);
+    state2.assign(state1.size(), 0);
+    settled.assign(groups, 0);
+    result.assign(lanes, BatchResult());
+}
+
+int BatchWorld::get_lanes() {
+    return lanes;
+}
+
+const char* BatchWorld::kernel() {
+    // 64 worlds fit one word and always take the scalar path
+    return groups > 1 && bytelife::has_avx2() ? "avx2" : "scalar";
+}
+
+void BatchWorld::random(double probability) {
+    std::random_device rd;
+    std::mt19937_64 gen(rd());
+    std::bernoulli_distribution dist(probability);
+    for (int i = 1; i <= height; i++) {
+        for (int j = 1; j <= width; j++) {
+            for (int g = 0; g < groups; g++) {
+                uint64_t bits = 0;
+                for (int b = 0; b < 64; b++) {
+                    bits |= uint64_t(dist(gen)) << b;
+                }
+                state1[index(i, j) + g] = bits;
+            }
+        }
+    }
+    edited = true;
+}
+
+void BatchWorld::set(int lane, int x, int y) {
+    if (lane >= 0 && lane < lanes && x > 0 && x <= height && y > 0 && y <= width) {
+        state1[index(x, y) + lane / 64] |= uint64_t(1) << (lane % 64);
+        edited = true;
+    }
+}
+
+int BatchWorld::get(int lane, int x, int y) {
+    if (lane >= 0 && lane < lanes && x > 0 && x <= height && y > 0 && y <= width) {
+        return (state1[index(x, y) + lane / 64] >> (lane % 64)) & 1;
+    }
+    return 100;
+}
+
+long long BatchWorld::population(int lane) {
+    long long n = 0;
+    for (int i = 1; i <= height; i++) {
+        for (int j = 1; j <= width; j++) {
+            n += get(lane, i, j);
+        }
+    }
+    return n;
+}
+
+void BatchWorld::restart() {
+    std::fill(settled.begin(), settled.end(), 0);
+    std::fill(result.begin(), result.end(), BatchResult());
+    snapshot = state1;
+    snapshot_generation = generation;
+    window = 1;
+    edited = false;
+}
+
+void BatchWorld::evolve() {
+    if (edited) {
+        restart();
+    }
+    if (groups == 1) {
+        evolve_lanes(state1.data(), state2.data(), height, width);
+    } else if (bytelife::has_avx2()) {
+        batchlife::evolve_avx2(state1.data(), state2.data(), height, width);
+    } else {
+        batchlife::evolve_256(state1.data(), state2.data(), height, width);
+    }
+    std::swap(state1, state2);
+    generation++;
+    detect();
+}
+
+void BatchWorld::detect() {
+    // bit L of diff is set if world L differs from the snapshot
+    std::vector<uint64_t> diff(groups, 0);
+    for (size_t c = 0; c < state1.size(); c += groups) {
+        for (int g = 0; g < groups; g++) {
+            diff[g] |= state1[c + g] ^ snapshot[c + g];
+        }
+    }
+    for (int g = 0; g < groups; g++) {
+        uint64_t fresh = ~diff[g] & ~settled[g];
+        settled[g] |= fresh;
+        for (; fresh != 0; fresh &= fresh - 1) {
+            int lane = g * 64 + __builtin_ctzll(fresh);
+            result[lane].population = population(lane);
+            result[lane].period = generation - snapshot_generation;
+            result[lane].generation = generation;
+        }
+    }
+    if (generation == snapshot_generation + window) {
+        snapshot = state1;
+        snapshot_generation = generation;
+        window = std::min(window * 2, max_window);
+    }
+}
+
+void BatchWorld::run(long long max_generations) {
+    long long stop = generation + max_generations;
+    while (generation < stop && !all_settled()) {
+        evolve();
+    }
+}
+
+bool BatchWorld::all_settled() {
+    if (edited) {
+        return false;
+    }
+    for (int g = 0; g < groups; g++) {
+        if (~settled[g] != 0) {
+            return false;
+        }
+    }
+    return true;
+}
+
+long long BatchWorld::get_generation() {
+    return generation;
+}
+
+const std::vector<BatchResult>& BatchWorld::results() {
+    return result;
+}
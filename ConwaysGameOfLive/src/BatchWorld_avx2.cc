@@ -0,0 +1,35 @@
+// Compiled with -mavx2, only called when the CPU supports it
+#include <cstdint>
+#include <cstddef>
+#include <immintrin.h>
+
+#include "include/BatchWorld.h"
+#include "include/BitLife.h"
+
+namespace batchlife {
+
+    void evolve_avx2(const uint64_t* in, uint64_t* out, int height, int width) {
+#ifdef __AVX2__
+        size_t stride = size_t(width + 2) * 4;
+        // one contiguous band of rows per thread
+        #pragma omp parallel for schedule(static)
+        for (int i = 1; i <= height; i++) {
+            const uint64_t* up = in + size_t(i - 1) * stride;
+            const uint64_t* mid = up + stride;
+            const uint64_t* dn = mid + stride;
+            uint64_t* res = out + size_t(i) * stride;
+            for (int j = 1; j <= width; j++) {
+#define CELL(row, k) _mm256_loadu_si256(reinterpret_cast<const __m256i*>(row + 4 * (k)))
+                // __m256i is a vector type to GCC and Clang, so bitlife::life applies as is
+                __m256i next = bitlife::life(CELL(up, j - 1), CELL(up, j), CELL(up, j + 1),
+                                             CELL(mid, j - 1), CELL(mid, j), CELL(mid, j + 1),
+                                             CELL(dn, j - 1), CELL(dn, j), CELL(dn, j + 1));
+#undef CELL
+                _mm256_storeu_si256(reinterpret_cast<__m256i*>(res + 4 * j), next);
+            }
+        }
+#else
+        evolve_256(in, out, height, width);
+#endif
+    }
+}
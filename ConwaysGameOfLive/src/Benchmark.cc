@@ -0,0 +1,270 @@
+#include <string>
+#include <vector>
+#include <memory>
+#include <chrono>
+#include <fstream>
+#include <sstream>
+#include <iostream>
+#include <algorithm>
+#include <stdexcept>
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+#if defined(__unix__) || defined(__APPLE__)
+#include <sys/resource.h>
+#endif
+
+#include "include/Benchmark.h"
+#include "include/Engine.h"
+#include "include/Numa.h"
+
+// Comma separated list of a flag
+static std::vector<std::string> split_list(const std::string& text) {
+    std::vector<std::string> items;
+    std::istringstream stream(text);
+    std::string item;
+    while (std::getline(stream, item, ',')) {
+        if (!item.empty()) {
+            items.push_back(item);
+        }
+    }
+    if (items.empty()) {
+        throw std::runtime_error("Empty list: " + text);
+    }
+    return items;
+}
+
+static size_t peak_rss() {
+#if defined(__unix__) || defined(__APPLE__)
+    struct rusage usage;
+    if (getrusage(RUSAGE_SELF, &usage) == 0) {
+#ifdef __APPLE__
+        return size_t(usage.ru_maxrss);
+#else
+        return size_t(usage.ru_maxrss) * 1024;
+#endif
+    }
+#endif
+    return 0;
+}
+
+Benchmark::Benchmark(int argc, char** argv) {
+    std::vector<std::string> size_list = {"1024"};
+    engines = {"world", "packed", "table", "byte"};
+    densities = {0.3};
+    threads = {1};
+    for (int i = 1; i < argc; i++) {
+        std::string flag = argv[i];
+        if (flag == "--bench") {
+            continue;
+        }
+        if (i + 1 >= argc) {
+            throw std::runtime_error("Missing value for " + flag);
+        }
+        std::string value = argv[++i];
+        if (flag == "--sizes") {
+            size_list = split_list(value);
+        } else if (flag == "--engines") {
+            engines = split_list(value);
+        } else if (flag == "--densities") {
+            densities.clear();
+            for (const std::string& d : split_list(value)) {
+                densities.push_back(std::stod(d));
+            }
+        } else if (flag == "--threads") {
+            threads.clear();
+            for (const std::string& t : split_list(value)) {
+                threads.push_back(std::stoi(t));
+            }
+        } else if (flag == "--generations") {
+            generations = std::stoi(value);
+        } else if (flag == "--warmup") {
+            warmup = std::stoi(value);
+        } else if (flag == "--repeat") {
+            repeat = std::stoi(value);
+        } else if (flag == "--pin") {
+            if (value != "0" && value != "1") {
+                throw std::runtime_error("--pin must be 0 or 1");
+            }
+            pin = value == "1";
+        } else if (flag == "--format") {
+            format = value;
+        } else if (flag == "--output") {
+            output = value;
+        } else {
+            throw std::runtime_error("Unknown flag: " + flag);
+        }
+    }
+    for (const std::string& s : size_list) {
+        // 1024 is a square grid, 512x2048 height times width
+        size_t x = s.find('x');
+        int height = std::stoi(s.substr(0, x));
+        int width = x == std::string::npos ? height : std::stoi(s.substr(x + 1));
+        if (height <= 0 || width <= 0) {
+            throw std::runtime_error("Height and width must be positive: " + s);
+        }
+        sizes.push_back(std::make_pair(height, width));
+    }
+    for (const std::string& e : engines) {
+        // throws for unknown engines before anything runs, a probe world would be too small
+        // for the process grid of distributed and create the file of mapped
+        check_engine_name(e);
+    }
+    for (double d : densities) {
+        if (d < 0 || d > 1) {
+            throw std::runtime_error("Density must be between 0 and 1");
+        }
+    }
+    for (int t : threads) {
+        if (t <= 0) {
+            throw std::runtime_error("Number of threads must be positive");
+        }
+#ifndef _OPENMP
+        if (t != 1) {
+            throw std::runtime_error("Built without OpenMP, only 1 thread available");
+        }
+#endif
+    }
+    if (generations <= 0 || warmup < 0 || repeat <= 0) {
+        throw std::runtime_error("Generations and repeat must be positive, warmup non-negative");
+    }
+    if (format != "json" && format != "csv") {
+        throw std::runtime_error("Format must be json or csv");
+    }
+}
+
+void Benchmark::usage(std::ostream& out) {
+    out << "Usage: game --bench [flags]\n"
+        << "  --sizes <list>       Grid sizes, 1024 for square or 512x2048 (default 1024)\n"
+        << "  --engines <list>     Engines to compare (default world,packed,table,byte)\n"
+        << "  --densities <list>   Share of living cells in the random world (default 0.3)\n"
+        << "  --threads <list>     Thread counts (default 1)\n"
+        << "  --generations <n>    Generations timed per repeat (default 100)\n"
+        << "  --warmup <n>         Generations evolved before timing (default 10)\n"
+        << "  --repeat <n>         Timed repeats, the median is reported (default 3)\n"
+        << "  --pin <0|1>          Pin thread t to the t-th CPU, node by node (default 1)\n"
+        << "  --format <json|csv>  Output format (default json)\n"
+        << "  --output <file>      Write the results to a file instead of stdout\n"
+        << "Lists are comma separated, e.g. --sizes 512,2048 --engines packed,byte --threads 1,4\n";
+}
+
+Benchmark::Result Benchmark::measure(const std::string& engine, int height, int width, double density, int n_threads) {
+#ifdef _OPENMP
+    omp_set_num_threads(n_threads);
+#endif
+    // before the engine is made, so the world engine places its rows on the final nodes
+    if (pin) {
+        numa::pin_threads();
+    } else if (numa::pinned()) {
+        numa::unpin_threads();
+    }
+    std::unique_ptr<Engine> world(make_engine(engine, height, width));
+    world->random(density);
+    world->advance(warmup);
+    std::vector<double> times;
+    for (int r = 0; r < repeat; r++) {
+        auto start = std::chrono::high_resolution_clock::now();
+        world->advance(generations);
+        auto end = std::chrono::high_resolution_clock::now();
+        std::chrono::duration<double> duration = end - start;
+        times.push_back(duration.count());
+    }
+    std::sort(times.begin(), times.end());
+    Result result;
+    result.engine = engine;
+    result.height = height;
+    result.width = width;
+    result.density = density;
+    result.threads = n_threads;
+    result.seconds = times[times.size() / 2];
+    result.seconds_min = times[0];
+    double cells = double(height) * width * generations;
+    result.cells_per_second = result.seconds > 0 ? cells / result.seconds : 0;
+    result.ns_per_cell = result.seconds * 1e9 / cells;
+    result.memory = world->memory();
+    result.peak_rss = peak_rss();
+    result.bandwidth = result.seconds > 0 ? double(result.memory) * generations / result.seconds : 0;
+    std::vector<int> team = numa::team_nodes();
+    int team_size = 0;
+    for (int n : team) {
+        team_size += n;
+    }
+    for (int n : team) {
+        result.node_bandwidth.push_back(team_size > 0 ? result.bandwidth * n / team_size : 0);
+    }
+    return result;
+}
+
+int Benchmark::run() {
+    for (const std::pair<int, int>& size : sizes) {
+        for (const std::string& engine : engines) {
+            for (double density : densities) {
+                for (int t : threads) {
+                    std::cerr << engine << " " << size.first << "x" << size.second << " density " << density
+                              << " threads " << t << " ... " << std::flush;
+                    results.push_back(measure(engine, size.first, size.second, density, t));
+                    std::cerr << results.back().cells_per_second << " cells/s" << std::endl;
+                }
+            }
+        }
+    }
+    std::ofstream file;
+    if (!output.empty()) {
+        file.open(output);
+        if (!file.is_open()) {
+            std::cerr << "Error: cannot write " << output << std::endl;
+            return 1;
+        }
+    }
+    std::ostream& out = output.empty() ? std::cout : file;
+    if (format == "json") {
+        write_json(out);
+    } else {
+        write_csv(out);
+    }
+    return 0;
+}
+
+void Benchmark::write_json(std::ostream& out) {
+    out << "{\n"
+        << "  \"generations\": " << generations << ",\n"
+        << "  \"warmup\": " << warmup << ",\n"
+        << "  \"repeat\": " << repeat << ",\n"
+        << "  \"pinned\": " << (pin ? "true" : "false") << ",\n"
+        << "  \"numa_nodes\": " << numa::nodes() << ",\n"
+#ifdef __VERSION__
+        << "  \"compiler\": \"" << __VERSION__ << "\",\n"
+#endif
+        << "  \"results\": [\n";
+    for (size_t i = 0; i < results.size(); i++) {
+        const Result& r = results[i];
+        out << "    {\"engine\": \"" << r.engine << "\", \"height\": " << r.height << ", \"width\": " << r.width
+            << ", \"density\": " << r.density << ", \"threads\": " << r.threads
+            << ", \"seconds\": " << r.seconds << ", \"seconds_min\": " << r.seconds_min
+            << ", \"cells_per_second\": " << r.cells_per_second << ", \"ns_per_cell\": " << r.ns_per_cell
+            << ", \"memory_bytes\": " << r.memory << ", \"peak_rss_bytes\": " << r.peak_rss
+            << ", \"est_bytes_per_second\": " << r.bandwidth << ", \"est_node_bytes_per_second\": [";
+        for (size_t n = 0; n < r.node_bandwidth.size(); n++) {
+            out << (n > 0 ? ", " : "") << r.node_bandwidth[n];
+        }
+        out << "]}"
+            << (i + 1 < results.size() ? "," : "") << "\n";
+    }
+    out << "  ]\n}" << std::endl;
+}
+
+void Benchmark::write_csv(std::ostream& out) {
+    out << "engine,height,width,density,threads,generations,seconds,seconds_min,cells_per_second,ns_per_cell,"
+        << "memory_bytes,peak_rss_bytes,est_bytes_per_second,est_node_bytes_per_second\n";
+    for (const Result& r : results) {
+        out << r.engine << "," << r.height << "," << r.width << "," << r.density << "," << r.threads << ","
+            << generations << "," << r.seconds << "," << r.seconds_min << "," << r.cells_per_second << ","
+            << r.ns_per_cell << "," << r.memory << "," << r.peak_rss << "," << r.bandwidth << ",";
+        // one figure per node, separated by semicolons to keep a single column
+        for (size_t n = 0; n < r.node_bandwidth.size(); n++) {
+            out << (n > 0 ? ";" : "") << r.node_bandwidth[n];
+        }
+        out << "\n";
+    }
+    out << std::flush;
+}
@@ -0,0 +1,190 @@
+#include <cstdint>
+#include <cstring>
+#include <random>
+#include <algorithm>
+
+#include "include/ByteWorld.h"
+#include "fvec/P4_I8vec16.h"
+
+ByteWorld::ByteWorld(): height(0), width(0), stride(2 * halo) {}
+
+ByteWorld::ByteWorld(int height, int width): height(height), width(width) {
+    stride = halo + size_t((width + 31) / 32) * 32 + halo;
+    state1.assign(size_t(height + 2) * stride, 0);
+    state2.assign(size_t(height + 2) * stride, 0);
+}
+
+int ByteWorld::get_height() {
+    return height;
+}
+
+int ByteWorld::get_width() {
+    return width;
+}
+
+const char* ByteWorld::kernel() {
+    return bytelife::has_avx2() ? "avx2" : "sse";
+}
+
+void ByteWorld::evolve() {
+    long long before = stats().population;
+    census::Tally tally;
+    if (bytelife::has_avx2()) {
+        state_hash = bytelife::evolve_avx2(state1.data(), state2.data(), height, width, stride, tally);
+    } else {
+        state_hash = bytelife::evolve_sse(state1.data(), state2.data(), height, width, stride, tally);
+    }
+    counted = tally.result(before);
+    counted_valid = true;
+    std::swap(state1, state2);
+}
+
+uint64_t ByteWorld::hash() {
+    return state_hash;
+}
+
+size_t ByteWorld::memory() {
+    return state1.capacity() + state2.capacity();
+}
+
+void ByteWorld::rehash() {
+    state_hash = 0;
+    for (int i = 1; i <= height; i++) {
+        state_hash ^= bytelife::row_hash(&cell(i, 1), width, i);
+    }
+}
+
+void ByteWorld::random(double probability) {
+    std::random_device rd;
+    std::mt19937 gen(rd());
+    std::bernoulli_distribution dist(probability);
+    for (int i = 1; i <= height; i++) {
+        for (int j = 1; j <= width; j++) {
+            cell(i, j) = dist(gen);
+        }
+    }
+    rehash();
+    counted_valid = false;
+}
+
+void ByteWorld::pack(uint64_t* rows) {
+    int words = (width + 63) / 64;
+    int rest = width % 64;
+    uint64_t last_mask = rest == 0 ? ~uint64_t(0) : (uint64_t(1) << rest) - 1;
+    const I8vec16 one(1);
+    #pragma omp parallel for schedule(static)
+    for (int i = 1; i <= height; i++) {
+        uint64_t* row = rows + size_t(i - 1) * words;
+        const uint8_t* cells = &cell(i, 1);
+        // 16 cells per movemask, a word may read past the row into halo and the next
+        // row, which the mask of the last word cuts off
+        for (int k = 0; k < words; k++) {
+            uint64_t w = 0;
+            for (int q = 0; q < 4; q++) {
+                uint64_t bits = uint16_t(_mm_movemask_epi8(I8vec16::load(cells + 64 * k + 16 * q) == one));
+                w |= bits << (16 * q);
+            }
+            row[k] = k == words - 1 ? w & last_mask : w;
+        }
+    }
+}
+
+void ByteWorld::unpack(const uint64_t* rows) {
+    int words = (width + 63) / 64;
+    #pragma omp parallel for schedule(static)
+    for (int i = 1; i <= height; i++) {
+        const uint64_t* row = rows + size_t(i - 1) * words;
+        for (int j = 1; j <= width; j++) {
+            cell(i, j) = uint8_t((row[(j - 1) / 64] >> ((j - 1) % 64)) & 1);
+        }
+    }
+    rehash();
+    counted_valid = false;
+}
+
+void ByteWorld::set(int x, int y) {
+    if (x > 0 && x <= height && y > 0 && y <= width) {
+        state_hash ^= bytelife::row_hash(&cell(x, 1), width, x);
+        cell(x, y) = 1;
+        state_hash ^= bytelife::row_hash(&cell(x, 1), width, x);
+        counted_valid = false;
+    }
+}
+
+void ByteWorld::set_run(int x, int y, int n) {
+    int first = std::max(y, 1);
+    int last = int(std::min<long long>((long long)y + n - 1, width));
+    if (x < 1 || x > height || first > last) {
+        return;
+    }
+    state_hash ^= bytelife::row_hash(&cell(x, 1), width, x);
+    std::memset(&cell(x, first), 1, last - first + 1);
+    state_hash ^= bytelife::row_hash(&cell(x, 1), width, x);
+    counted_valid = false;
+}
+
+int ByteWorld::get(int x, int y) {
+    if (x > 0 && x <= height && y > 0 && y <= width) {
+        return cell(x, y);
+    }
+    return 100;
+}
+
+namespace bytelife {
+
+    bool has_avx2() {
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+        static const bool avx2 = __builtin_cpu_supports("avx2");
+        return avx2;
+#else
+        return false;
+#endif
+    }
+
+    uint64_t evolve_sse(const uint8_t* in, uint8_t* out, int height, int width, size_t stride, census::Tally& tally) {
+        const I8vec16 zero, two(2), three(3), one(1);
+        uint8_t lanes[i8vecLen];
+        last_lanes(lanes, i8vecLen, width, 1);
+        const I8vec16 last_one = I8vec16::load(lanes);
+        uint64_t h = 0;
+        census::Tally counts;
+        // one contiguous band of rows per thread
+        #pragma omp parallel for schedule(static) reduction(^:h) reduction(tally:counts)
+        for (int i = 1; i <= height; i++) {
+            const uint8_t* mid = in + size_t(i) * stride + ByteWorld::halo;
+            const uint8_t* up = mid - stride;
+            const uint8_t* dn = mid + stride;
+            uint8_t* res = out + size_t(i) * stride + ByteWorld::halo;
+            __m128i population = zero;
+            __m128i changes = zero;
+            for (int j0 = 0; j0 < width; j0 += count_block * i8vecLen) {
+                int j1 = std::min(width, j0 + count_block * i8vecLen);
+                I8vec16 living, changed;
+                for (int j = j0; j < j1; j += i8vecLen) {
+                    I8vec16 alive = I8vec16::load(mid + j);
+                    I8vec16 sum = I8vec16::load(up + j - 1) + I8vec16::load(up + j) + I8vec16::load(up + j + 1)
+                                + I8vec16::load(mid + j - 1) + I8vec16::load(mid + j + 1)
+                                + I8vec16::load(dn + j - 1) + I8vec16::load(dn + j) + I8vec16::load(dn + j + 1);
+                    // alive with 2 or 3 neighbours, or dead with exactly 3, lanes right of the last column stay dead
+                    I8vec16 next = ((sum == three) | ((sum == two) & (alive == one))) & (j + i8vecLen <= width ? one : last_one);
+                    store(res + j, next);
+                    living = living + next;
+                    changed = changed + (next ^ alive);
+                }
+                population = _mm_add_epi64(population, _mm_sad_epu8(living, zero));
+                changes = _mm_add_epi64(changes, _mm_sad_epu8(changed, zero));
+            }
+            // the last vector may have spilled into the right halo
+            std::memset(res + width, 0, stride - ByteWorld::halo - width);
+            h ^= row_hash(res, width, i);
+            long long row_population = lane_sum(population);
+            if (row_population > 0) {
+                counts.population += row_population;
+                span_row(counts, i, res, width);
+            }
+            counts.changes += lane_sum(changes);
+        }
+        tally = counts;
+        return h;
+    }
+}
@@ -0,0 +1,70 @@
+// Compiled with -mavx2, only called when the CPU supports it
+#include <cstdint>
+#include <cstring>
+#include <algorithm>
+#include <immintrin.h>
+
+#include "include/ByteWorld.h"
+
+namespace bytelife {
+
+    uint64_t evolve_avx2(const uint8_t* in, uint8_t* out, int height, int width, size_t stride, census::Tally& tally) {
+#ifdef __AVX2__
+        uint64_t h = 0;
+        census::Tally counts;
+        const __m256i zero = _mm256_setzero_si256();
+        const __m256i one = _mm256_set1_epi8(1);
+        const __m256i two = _mm256_set1_epi8(2);
+        const __m256i three = _mm256_set1_epi8(3);
+        uint8_t lanes[32];
+        last_lanes(lanes, 32, width, 1);
+        const __m256i last_one = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(lanes));
+        // one contiguous band of rows per thread
+        #pragma omp parallel for schedule(static) reduction(^:h) reduction(tally:counts)
+        for (int i = 1; i <= height; i++) {
+            const uint8_t* mid = in + size_t(i) * stride + ByteWorld::halo;
+            const uint8_t* up = mid - stride;
+            const uint8_t* dn = mid + stride;
+            uint8_t* res = out + size_t(i) * stride + ByteWorld::halo;
+            __m256i population = zero;
+            __m256i changes = zero;
+            for (int j0 = 0; j0 < width; j0 += count_block * 32) {
+                int j1 = std::min(width, j0 + count_block * 32);
+                __m256i living = zero;
+                __m256i changed = zero;
+                for (int j = j0; j < j1; j += 32) {
+#define LOAD(p) _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p))
+                    __m256i alive = LOAD(mid + j);
+                    __m256i sum = _mm256_add_epi8(_mm256_add_epi8(LOAD(up + j - 1), LOAD(up + j)),
+                                                  _mm256_add_epi8(LOAD(up + j + 1), LOAD(mid + j - 1)));
+                    sum = _mm256_add_epi8(sum, _mm256_add_epi8(_mm256_add_epi8(LOAD(mid + j + 1), LOAD(dn + j - 1)),
+                                                               _mm256_add_epi8(LOAD(dn + j), LOAD(dn + j + 1))));
+#undef LOAD
+                    // alive with 2 or 3 neighbours, or dead with exactly 3
+                    __m256i next = _mm256_or_si256(_mm256_cmpeq_epi8(sum, three),
+                                                   _mm256_and_si256(_mm256_cmpeq_epi8(sum, two), _mm256_cmpeq_epi8(alive, one)));
+                    // lanes right of the last column stay dead, so they count as nothing
+                    next = _mm256_and_si256(next, j + 32 <= width ? one : last_one);
+                    _mm256_storeu_si256(reinterpret_cast<__m256i*>(res + j), next);
+                    living = _mm256_add_epi8(living, next);
+                    changed = _mm256_add_epi8(changed, _mm256_xor_si256(next, alive));
+                }
+                population = _mm256_add_epi64(population, _mm256_sad_epu8(living, zero));
+                changes = _mm256_add_epi64(changes, _mm256_sad_epu8(changed, zero));
+            }
+            // the last vector may have spilled into the right halo
+            std::memset(res + width, 0, stride - ByteWorld::halo - width);
+            h ^= row_hash(res, width, i);
+            if (!_mm256_testz_si256(population, population)) {
+                counts.population += lane_sum(population);
+                span_row(counts, i, res, width);
+            }
+            counts.changes += lane_sum(changes);
+        }
+        tally = counts;
+        return h;
+#else
+        return evolve_sse(in, out, height, width, stride, tally);
+#endif
+    }
+}
@@ -0,0 +1,89 @@
+#include <cstdint>
+
+#include "include/Census.h"
+
+namespace {
+    inline void count_words(census::Tally& t, long long row, long long col, const uint64_t* now, const uint64_t* before, int n) {
+        int first = -1;
+        int last = -1;
+        for (int k = 0; k < n; k++) {
+            t.population += __builtin_popcountll(now[k]);
+            t.changes += __builtin_popcountll(now[k] ^ before[k]);
+            if (now[k] != 0) {
+                first = first < 0 ? k : first;
+                last = k;
+            }
+        }
+        if (first >= 0) {
+            t.span(row, col + 64 * first + __builtin_ctzll(now[first]),
+                   col + 64 * last + 63 - __builtin_clzll(now[last]));
+        }
+    }
+
+    inline void count_rows(census::Tally& t, long long row, long long col, const uint64_t* now, const uint64_t* before, int n) {
+        for (int k = 0; k < n; k++) {
+            t.population += __builtin_popcountll(now[k]);
+            t.changes += __builtin_popcountll(now[k] ^ before[k]);
+            if (now[k] != 0) {
+                t.span(row + k, col + __builtin_ctzll(now[k]), col + 63 - __builtin_clzll(now[k]));
+            }
+        }
+    }
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+    // the same loops with popcnt allowed, x86-64 without it calls a library routine per word
+    __attribute__((target("popcnt")))
+    void count_words_popcnt(census::Tally& t, long long row, long long col, const uint64_t* now, const uint64_t* before, int n) {
+        count_words(t, row, col, now, before, n);
+    }
+
+    __attribute__((target("popcnt")))
+    void count_rows_popcnt(census::Tally& t, long long row, long long col, const uint64_t* now, const uint64_t* before, int n) {
+        count_rows(t, row, col, now, before, n);
+    }
+
+    bool has_popcnt() {
+        static const bool popcnt = __builtin_cpu_supports("popcnt");
+        return popcnt;
+    }
+#endif
+}
+
+namespace census {
+    void Tally::words(long long row, long long col, const uint64_t* now, const uint64_t* before, int n) {
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+        if (has_popcnt()) {
+            count_words_popcnt(*this, row, col, now, before, n);
+            return;
+        }
+#endif
+        count_words(*this, row, col, now, before, n);
+    }
+
+    void Tally::rows(long long row, long long col, const uint64_t* now, const uint64_t* before, int n) {
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+        if (has_popcnt()) {
+            count_rows_popcnt(*this, row, col, now, before, n);
+            return;
+        }
+#endif
+        count_rows(*this, row, col, now, before, n);
+    }
+
+    Stats Tally::result(long long before_population) const {
+        Stats s;
+        s.population = population;
+        // births - deaths is the change in population and births + deaths the changed cells
+        if (before_population >= 0) {
+            s.births = (changes + population - before_population) / 2;
+            s.deaths = changes - s.births;
+        }
+        if (population > 0) {
+            s.min_row = min_row;
+            s.max_row = max_row;
+            s.min_col = min_col;
+            s.max_col = max_col;
+        }
+        return s;
+    }
+}
@@ -0,0 +1,95 @@
+#include <string>
+#include <chrono>
+#include <stdexcept>
+#include <algorithm>
+
+#include "include/Checkpoint.h"
+#include "include/Numa.h"
+
+Checkpointer::Checkpointer(const std::string& path, long long generations, double seconds, long long generation)
+    : path(path), every_generations(generations), every_seconds(seconds), last_generation(generation),
+      last_time(std::chrono::steady_clock::now()) {
+    writer = std::thread(&Checkpointer::write_loop, this);
+}
+
+Checkpointer::~Checkpointer() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stop = true;
+    }
+    wake.notify_all();
+    writer.join();
+}
+
+void Checkpointer::write_loop() {
+    numa::unpin_this_thread();
+    std::unique_lock<std::mutex> lock(mutex);
+    while (true) {
+        wake.wait(lock, [this] { return busy || stop; });
+        if (!busy) {
+            return;
+        }
+        // the simulation does not touch spare until busy is cleared
+        lock.unlock();
+        std::string message;
+        try {
+            spare.write(path, true);
+        } catch (const std::exception& e) {
+            message = e.what();
+        }
+        lock.lock();
+        if (message.empty()) {
+            written = spare.generation;
+        } else {
+            failure = message;
+        }
+        busy = false;
+    }
+}
+
+bool Checkpointer::due(long long generation) {
+    // a world created or loaded since starts counting again
+    if (every_generations > 0 && (generation - last_generation >= every_generations || generation < last_generation)) {
+        return true;
+    }
+    std::chrono::duration<double> since = std::chrono::steady_clock::now() - last_time;
+    return every_seconds > 0 && since.count() >= every_seconds;
+}
+
+long long Checkpointer::until_due(long long generation) {
+    if (every_seconds > 0 || every_generations <= 0) {
+        return 1;
+    }
+    return std::min(std::max(every_generations - (generation - last_generation), 1LL), every_generations);
+}
+
+bool Checkpointer::capture(Engine& world, long long generation, const Rule& rule, bool torus) {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (busy) {
+            return false;
+        }
+    }
+    // the writer is idle and waits for busy, so spare can be filled without the lock
+    spare.capture(world, generation, rule, torus);
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        busy = true;
+    }
+    wake.notify_all();
+    last_generation = generation;
+    last_time = std::chrono::steady_clock::now();
+    return true;
+}
+
+long long Checkpointer::last_written() {
+    std::lock_guard<std::mutex> lock(mutex);
+    return written;
+}
+
+std::string Checkpointer::error() {
+    std::lock_guard<std::mutex> lock(mutex);
+    std::string message;
+    message.swap(failure);
+    return message;
+}
@@ -0,0 +1,51 @@
+#include <cstdint>
+#include <vector>
+#include <unordered_map>
+
+#include "include/CycleDetector.h"
+
+CycleDetector::CycleDetector(size_t capacity): capacity(capacity), ring(capacity) {}
+
+void CycleDetector::reset() {
+    seen.clear();
+    first = 0;
+    last = -1;
+    cycle_start = -1;
+    cycle_period = 0;
+}
+
+bool CycleDetector::push(uint64_t hash, long long generation) {
+    if (last >= 0 && generation != last + 1) {
+        reset();
+    }
+    if (last < 0) {
+        first = generation;
+    }
+    auto it = seen.find(hash);
+    if (it != seen.end()) {
+        cycle_start = it->second;
+        cycle_period = generation - it->second;
+        return true;
+    }
+    // evict the oldest generation once the ring is full
+    if (generation - first >= (long long)capacity) {
+        uint64_t old = ring[first % capacity];
+        auto old_it = seen.find(old);
+        if (old_it != seen.end() && old_it->second == first) {
+            seen.erase(old_it);
+        }
+        first++;
+    }
+    ring[generation % capacity] = hash;
+    seen[hash] = generation;
+    last = generation;
+    return false;
+}
+
+long long CycleDetector::start() {
+    return cycle_start;
+}
+
+long long CycleDetector::period() {
+    return cycle_period;
+}
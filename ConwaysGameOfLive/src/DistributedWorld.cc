@@ -0,0 +1,558 @@
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <random>
+#include <limits>
+#include <algorithm>
+#include <stdexcept>
+
+#include "include/DistributedWorld.h"
+#include "include/Hash.h"
+
+#ifdef HAVE_MPI
+
+// Worlds served by the ranks other than 0, by id
+static std::map<int, std::unique_ptr<DistributedWorld> > served;
+
+static int next_id = 0;
+
+static int rank() {
+    int r = 0;
+    MPI_Comm_rank(MPI_COMM_WORLD, &r);
+    return r;
+}
+
+// Part k of n cells split into parts pieces whose sizes differ by at most one
+static void split(int n, int parts, int k, int& first, int& count) {
+    count = n / parts + (k < n % parts ? 1 : 0);
+    first = k * (n / parts) + std::min(k, n % parts);
+}
+
+namespace distributed {
+
+    Session::Session(int& argc, char**& argv) {
+        int provided = 0;
+        // only the thread outside the OpenMP regions talks to other ranks
+        MPI_Init_thread(&argc, &argv, MPI_THREAD_FUNNELED, &provided);
+        root = rank() == 0;
+    }
+
+    Session::~Session() {
+        if (root) {
+            DistributedWorld::Command c = {DistributedWorld::EXIT, -1, 0, 0, 0};
+            MPI_Bcast(&c, sizeof(c), MPI_BYTE, 0, MPI_COMM_WORLD);
+        }
+        MPI_Finalize();
+    }
+
+    void Session::serve() {
+        while (true) {
+            DistributedWorld::Command c;
+            MPI_Bcast(&c, sizeof(c), MPI_BYTE, 0, MPI_COMM_WORLD);
+            if (c.op == DistributedWorld::EXIT) {
+                served.clear();
+                return;
+            }
+            if (c.op == DistributedWorld::CREATE) {
+                served[c.id].reset(new DistributedWorld(c));
+            } else if (c.op == DistributedWorld::DESTROY) {
+                served.erase(c.id);
+            } else {
+                served.at(c.id)->execute(c);
+            }
+        }
+    }
+}
+
+DistributedWorld::DistributedWorld(int height, int width): id(next_id++), height(height), width(width) {
+    int size = 0;
+    MPI_Comm_size(MPI_COMM_WORLD, &size);
+    int d[2] = {0, 0};
+    MPI_Dims_create(size, 2, d);
+    if (height < d[0] || width < d[1]) {
+        throw std::runtime_error("A " + std::to_string(height) + "x" + std::to_string(width) + " world is too small for "
+                                 + std::to_string(d[0]) + "x" + std::to_string(d[1]) + " processes");
+    }
+    Command c = {CREATE, id, height, width, 0};
+    MPI_Bcast(&c, sizeof(c), MPI_BYTE, 0, MPI_COMM_WORLD);
+    connect();
+}
+
+DistributedWorld::DistributedWorld(const Command& create): id(create.id), height(int(create.a)), width(int(create.b)) {
+    connect();
+}
+
+DistributedWorld::~DistributedWorld() {
+    if (rank() == 0) {
+        Command c = {DESTROY, id, 0, 0, 0};
+        MPI_Bcast(&c, sizeof(c), MPI_BYTE, 0, MPI_COMM_WORLD);
+    }
+    disconnect();
+}
+
+void DistributedWorld::connect() {
+    int size = 0;
+    MPI_Comm_size(MPI_COMM_WORLD, &size);
+    dims[0] = dims[1] = 0;
+    MPI_Dims_create(size, 2, dims);
+    int periods[2] = {torus, torus};
+    MPI_Cart_create(MPI_COMM_WORLD, 2, dims, periods, 0, &grid);
+    int me = 0;
+    MPI_Comm_rank(grid, &me);
+    MPI_Cart_coords(grid, me, 2, coords);
+    int new_rows = 0;
+    int new_cols = 0;
+    split(height, dims[0], coords[0], row0, new_rows);
+    split(width, dims[1], coords[1], col0, new_cols);
+    if (new_rows != rows || new_cols != cols) {
+        rows = new_rows;
+        cols = new_cols;
+        stride = size_t(cols) + 2;
+        state1.assign((rows + 2) * stride, 0);
+        state2.assign((rows + 2) * stride, 0);
+        row_counts.resize(rows + 2);
+        col_weight.resize(cols + 2);
+        for (int j = 0; j < cols + 2; j++) {
+            col_weight[j] = uint32_t(hashing::mix64(col0 + j + 1));
+        }
+    }
+    for (int dr = -1; dr <= 1; dr++) {
+        for (int dc = -1; dc <= 1; dc++) {
+            int d = 3 * (dr + 1) + (dc + 1);
+            int at[2] = {coords[0] + dr, coords[1] + dc};
+            if (torus) {
+                at[0] = (at[0] + dims[0]) % dims[0];
+                at[1] = (at[1] + dims[1]) % dims[1];
+            }
+            if (at[0] < 0 || at[0] >= dims[0] || at[1] < 0 || at[1] >= dims[1]) {
+                // the plane ends here, the halo stays dead
+                neighbour[d] = MPI_PROC_NULL;
+            } else {
+                MPI_Cart_rank(grid, at, &neighbour[d]);
+            }
+            // a full edge row, a column of rows cells stride bytes apart or a corner
+            MPI_Type_vector(dr == 0 ? rows : 1, dc == 0 ? cols : 1, int(stride), MPI_UINT8_T, &edge[d]);
+            MPI_Type_commit(&edge[d]);
+        }
+    }
+}
+
+void DistributedWorld::disconnect() {
+    for (int d = 0; d < 9; d++) {
+        MPI_Type_free(&edge[d]);
+    }
+    MPI_Comm_free(&grid);
+}
+
+void DistributedWorld::command(int op, int64_t a, int64_t b, double p) {
+    Command c = {op, id, a, b, p};
+    MPI_Bcast(&c, sizeof(c), MPI_BYTE, 0, MPI_COMM_WORLD);
+    execute(c);
+}
+
+void DistributedWorld::execute(const Command& c) {
+    switch (c.op) {
+        case ADVANCE:
+            advance_local(int(c.a));
+            break;
+        case SET: {
+            int i = int(c.a) - row0;
+            int j = int(c.b) - col0;
+            if (i >= 1 && i <= rows && j >= 1 && j <= cols) {
+                cell(i, j) = 1;
+                local_valid = false;
+            }
+            // births and deaths are unknown on every rank until the next generation
+            local.births = local.deaths = -1;
+            break;
+        }
+        case RANDOM: {
+            std::random_device rd;
+            std::mt19937 gen(rd() ^ uint32_t(rank()));
+            std::bernoulli_distribution dist(c.p);
+            for (int i = 1; i <= rows; i++) {
+                for (int j = 1; j <= cols; j++) {
+                    cell(i, j) = dist(gen);
+                }
+            }
+            local_valid = false;
+            local.births = local.deaths = -1;
+            break;
+        }
+        case RULE:
+            rule = Rule(uint32_t(c.a), uint32_t(c.b));
+            break;
+        case TORUS:
+            disconnect();
+            torus = c.a != 0;
+            connect();
+            if (!torus) {
+                // halos of the old wrap-around neighbours would otherwise live on
+                for (std::vector<uint8_t>* state : {&state1, &state2}) {
+                    for (int i = 0; i < rows + 2; i++) {
+                        (*state)[i * stride] = (*state)[i * stride + cols + 1] = 0;
+                    }
+                    std::fill(state->begin(), state->begin() + stride, 0);
+                    std::fill(state->end() - stride, state->end(), 0);
+                }
+            }
+            break;
+        case STATS:
+            counted = reduce_stats();
+            break;
+        case HASH: {
+            if (!local_valid) {
+                recount();
+            }
+            MPI_Reduce(&state_hash, &result, 1, MPI_UINT64_T, MPI_BXOR, 0, MPI_COMM_WORLD);
+            break;
+        }
+        case MEMORY: {
+            uint64_t bytes = state1.capacity() + state2.capacity() + row_counts.capacity() * sizeof(RowCount)
+                             + col_weight.capacity() * sizeof(uint32_t) + band.capacity() * sizeof(uint64_t);
+            MPI_Reduce(&bytes, &result, 1, MPI_UINT64_T, MPI_SUM, 0, MPI_COMM_WORLD);
+            break;
+        }
+        case GATHER:
+            gather(int(c.a), int(c.b));
+            break;
+        default:
+            break;
+    }
+}
+
+void DistributedWorld::recount() {
+    long long births = local.births;
+    long long deaths = local.deaths;
+    local = Stats();
+    local.births = births;
+    local.deaths = deaths;
+    local.min_row = local.min_col = std::numeric_limits<long long>::max();
+    local.max_row = local.max_col = std::numeric_limits<long long>::min();
+    state_hash = 0;
+    for (int i = 1; i <= rows; i++) {
+        uint32_t sum = 0;
+        for (int j = 1; j <= cols; j++) {
+            if (cell(i, j)) {
+                sum += col_weight[j];
+                local.population++;
+                local.min_row = std::min<long long>(local.min_row, row0 + i);
+                local.max_row = std::max<long long>(local.max_row, row0 + i);
+                local.min_col = std::min<long long>(local.min_col, col0 + j);
+                local.max_col = std::max<long long>(local.max_col, col0 + j);
+            }
+        }
+        state_hash ^= hashing::segment(row0 + i, coords[1], sum);
+    }
+    local_valid = true;
+}
+
+// Evolves the local rows [i0, i1) and columns [c0, c1) from state1 into state2
+template <class R>
+void DistributedWorld::evolve_rect(int i0, int i1, int c0, int c1, const R& r, long long& births, long long& deaths) {
+    #pragma omp parallel for schedule(static) reduction(+:births, deaths)
+    for (int i = i0; i < i1; i++) {
+        const uint8_t* mid = &state1[size_t(i) * stride];
+        const uint8_t* up = mid - stride;
+        const uint8_t* dn = mid + stride;
+        uint8_t* __restrict out = &state2[size_t(i) * stride];
+        int row_births = 0;
+        int row_deaths = 0;
+        int row_alive = 0;
+        uint32_t old_sum = 0;
+        uint32_t new_sum = 0;
+        for (int j = c0; j < c1; j++) {
+            int n_sum = up[j-1] + up[j] + up[j+1] + mid[j-1] + mid[j+1] + dn[j-1] + dn[j] + dn[j+1];
+            int alive = r.next(n_sum, mid[j]);
+            out[j] = uint8_t(alive);
+            row_births += alive & ~mid[j];
+            row_deaths += mid[j] & ~alive;
+            row_alive |= alive;
+            old_sum += col_weight[j] & -uint32_t(mid[j]);
+            new_sum += col_weight[j] & -uint32_t(alive);
+        }
+        // a row is split over up to three pieces, each adds its part
+        RowCount& rc = row_counts[i];
+        rc.old_sum += old_sum;
+        rc.new_sum += new_sum;
+        if (row_alive) {
+            int first = c0;
+            while (out[first] == 0) {
+                first++;
+            }
+            int last = c1 - 1;
+            while (out[last] == 0) {
+                last--;
+            }
+            rc.first = std::min(rc.first, first);
+            rc.last = std::max(rc.last, last);
+        }
+        births += row_births;
+        deaths += row_deaths;
+    }
+}
+
+template <class R>
+void DistributedWorld::step(const R& r) {
+    if (!local_valid) {
+        recount();
+    }
+    for (int i = 1; i <= rows; i++) {
+        row_counts[i].old_sum = row_counts[i].new_sum = 0;
+        row_counts[i].first = std::numeric_limits<int>::max();
+        row_counts[i].last = std::numeric_limits<int>::min();
+    }
+    MPI_Request requests[16];
+    int n = 0;
+    for (int d = 0; d < 9; d++) {
+        if (d == 4) {
+            continue;
+        }
+        int dr = d / 3 - 1;
+        int dc = d % 3 - 1;
+        size_t halo = size_t(dr < 0 ? 0 : dr == 0 ? 1 : rows + 1) * stride + (dc < 0 ? 0 : dc == 0 ? 1 : cols + 1);
+        size_t rim = size_t(dr > 0 ? rows : 1) * stride + (dc > 0 ? cols : 1);
+        // the neighbour in direction d sends its edge facing us, tagged with its own direction
+        MPI_Irecv(&state1[halo], 1, edge[d], neighbour[d], 8 - d, grid, &requests[n++]);
+        MPI_Isend(&state1[rim], 1, edge[d], neighbour[d], d, grid, &requests[n++]);
+    }
+    long long births = 0;
+    long long deaths = 0;
+    // the interior reads no halo cell, so it is evolved while the halos are on their way
+    evolve_rect(2, rows, 2, cols, r, births, deaths);
+    MPI_Waitall(n, requests, MPI_STATUSES_IGNORE);
+    evolve_rect(1, 2, 1, cols + 1, r, births, deaths);
+    if (rows > 1) {
+        evolve_rect(rows, rows + 1, 1, cols + 1, r, births, deaths);
+    }
+    evolve_rect(2, rows, 1, 2, r, births, deaths);
+    if (cols > 1) {
+        evolve_rect(2, rows, cols, cols + 1, r, births, deaths);
+    }
+    long long population = local.population + births - deaths;
+    local = Stats();
+    local.population = population;
+    local.births = births;
+    local.deaths = deaths;
+    local.min_row = local.min_col = std::numeric_limits<long long>::max();
+    local.max_row = local.max_col = std::numeric_limits<long long>::min();
+    for (int i = 1; i <= rows; i++) {
+        const RowCount& rc = row_counts[i];
+        if (rc.old_sum != rc.new_sum) {
+            state_hash ^= hashing::segment(row0 + i, coords[1], rc.old_sum) ^ hashing::segment(row0 + i, coords[1], rc.new_sum);
+        }
+        if (rc.first <= rc.last) {
+            local.min_row = std::min<long long>(local.min_row, row0 + i);
+            local.max_row = row0 + i;
+            local.min_col = std::min<long long>(local.min_col, col0 + rc.first);
+            local.max_col = std::max<long long>(local.max_col, col0 + rc.last);
+        }
+    }
+    std::swap(state1, state2);
+}
+
+void DistributedWorld::advance_local(int generations) {
+    for (int k = 0; k < generations; k++) {
+        if (rule.is_life()) {
+            step(FixedRule<0x008, 0x00c>());
+        } else {
+            step(AnyRule(rule));
+        }
+    }
+}
+
+Stats DistributedWorld::reduce_stats() {
+    if (!local_valid) {
+        recount();
+    }
+    const long long none = std::numeric_limits<long long>::max();
+    bool any = local.population > 0;
+    long long sums[3] = {local.population, local.births, local.deaths};
+    // maxima are reduced as minima of their negation, the last entry is 0 if a rank lost count
+    long long mins[5] = {any ? local.min_row : none, any ? local.min_col : none, any ? -local.max_row : none,
+                         any ? -local.max_col : none, local.births >= 0 ? 1 : 0};
+    long long total[3] = {0, 0, 0};
+    long long least[5] = {0, 0, 0, 0, 0};
+    MPI_Reduce(sums, total, 3, MPI_LONG_LONG, MPI_SUM, 0, MPI_COMM_WORLD);
+    MPI_Reduce(mins, least, 5, MPI_LONG_LONG, MPI_MIN, 0, MPI_COMM_WORLD);
+    Stats s;
+    s.population = total[0];
+    s.births = least[4] ? total[1] : -1;
+    s.deaths = least[4] ? total[2] : -1;
+    if (s.population > 0) {
+        s.min_row = least[0];
+        s.min_col = least[1];
+        s.max_row = -least[2];
+        s.max_col = -least[3];
+    }
+    return s;
+}
+
+int DistributedWorld::band_height() const {
+    return std::max(1, std::min(height, int((size_t(1) << 20) / size_t(words()))));
+}
+
+void DistributedWorld::gather(int first, int n) {
+    // the local rows inside the band, packed from the first local column on
+    int local_words = (cols + 63) / 64;
+    int from = std::max(first, row0 + 1);
+    int to = std::min(first + n - 1, row0 + rows);
+    std::vector<uint64_t> block(size_t(std::max(0, to - from + 1)) * local_words, 0);
+    for (int x = from; x <= to; x++) {
+        uint64_t* row = &block[size_t(x - from) * local_words];
+        const uint8_t* cells = &cell(x - row0, 1);
+        for (int j = 0; j < cols; j++) {
+            row[j / 64] |= uint64_t(cells[j] & 1) << (j % 64);
+        }
+    }
+    int size = 0;
+    MPI_Comm_size(MPI_COMM_WORLD, &size);
+    std::vector<int> counts(size);
+    std::vector<int> displs(size);
+    std::vector<uint64_t> all;
+    if (rank() == 0) {
+        // a band is at most band_height rows, so the counts fit an int
+        for (int r = 0, at = 0; r < size; r++) {
+            int c[2];
+            int r0 = 0;
+            int c0 = 0;
+            int n_rows = 0;
+            int n_cols = 0;
+            MPI_Cart_coords(grid, r, 2, c);
+            split(height, dims[0], c[0], r0, n_rows);
+            split(width, dims[1], c[1], c0, n_cols);
+            int overlap = std::max(0, std::min(first + n - 1, r0 + n_rows) - std::max(first, r0 + 1) + 1);
+            counts[r] = overlap * ((n_cols + 63) / 64);
+            displs[r] = at;
+            at += counts[r];
+        }
+        all.resize(size_t(displs[size - 1]) + counts[size - 1]);
+    }
+    MPI_Gatherv(block.data(), int(block.size()), MPI_UINT64_T, all.data(), counts.data(), displs.data(),
+                MPI_UINT64_T, 0, MPI_COMM_WORLD);
+    if (rank() != 0) {
+        return;
+    }
+    int n_words = words();
+    band.assign(size_t(n) * n_words, 0);
+    for (int r = 0; r < size; r++) {
+        int c[2];
+        int r0 = 0;
+        int c0 = 0;
+        int n_rows = 0;
+        int n_cols = 0;
+        MPI_Cart_coords(grid, r, 2, c);
+        split(height, dims[0], c[0], r0, n_rows);
+        split(width, dims[1], c[1], c0, n_cols);
+        int lw = (n_cols + 63) / 64;
+        int shift = c0 % 64;
+        int from_r = std::max(first, r0 + 1);
+        for (int i = 0; i < counts[r] / std::max(lw, 1); i++) {
+            const uint64_t* in = &all[displs[r] + size_t(i) * lw];
+            uint64_t* out = &band[size_t(from_r - first + i) * n_words + c0 / 64];
+            // the block starts at column c0 + 1, shifted into place across word boundaries
+            for (int k = 0; k < lw; k++) {
+                out[k] |= in[k] << shift;
+                if (shift != 0 && c0 / 64 + k + 1 < n_words) {
+                    out[k + 1] |= in[k] >> (64 - shift);
+                }
+            }
+        }
+    }
+    band_first = first;
+    band_rows = n;
+}
+
+const uint64_t* DistributedWorld::band_row(int x) {
+    if (band_rows == 0 || x < band_first || x >= band_first + band_rows) {
+        int n = band_height();
+        int first = (x - 1) / n * n + 1;
+        command(GATHER, first, std::min(n, height - first + 1));
+    }
+    return &band[size_t(x - band_first) * words()];
+}
+
+void DistributedWorld::pack(uint64_t* rows) {
+    int n_words = words();
+    for (int x = 1; x <= height; x += band_height()) {
+        const uint64_t* row = band_row(x);
+        std::copy(row, row + size_t(band_rows) * n_words, rows + size_t(x - 1) * n_words);
+    }
+}
+
+int DistributedWorld::get_height() {
+    return height;
+}
+
+int DistributedWorld::get_width() {
+    return width;
+}
+
+void DistributedWorld::evolve() {
+    advance(1);
+}
+
+void DistributedWorld::advance(int generations) {
+    band_rows = 0;
+    command(ADVANCE, generations);
+}
+
+void DistributedWorld::set_rule(const Rule& rule) {
+    if (rule.states != 2) {
+        throw std::runtime_error("The distributed engine only runs two state rules, use the generations engine");
+    }
+    command(RULE, rule.birth, rule.survive);
+}
+
+void DistributedWorld::set_torus(bool torus) {
+    command(TORUS, torus);
+}
+
+uint64_t DistributedWorld::hash() {
+    command(HASH);
+    return result;
+}
+
+Stats DistributedWorld::stats() {
+    command(STATS);
+    return counted;
+}
+
+size_t DistributedWorld::memory() {
+    command(MEMORY);
+    return size_t(result);
+}
+
+void DistributedWorld::random(double probability) {
+    band_rows = 0;
+    command(RANDOM, 0, 0, probability);
+}
+
+void DistributedWorld::set(int x, int y) {
+    if (x > 0 && x <= height && y > 0 && y <= width) {
+        if (band_rows > 0 && x >= band_first && x < band_first + band_rows) {
+            band[size_t(x - band_first) * words() + (y - 1) / 64] |= uint64_t(1) << ((y - 1) % 64);
+        }
+        command(SET, x, y);
+    }
+}
+
+int DistributedWorld::get(int x, int y) {
+    if (x > 0 && x <= height && y > 0 && y <= width) {
+        return int((band_row(x)[(y - 1) / 64] >> ((y - 1) % 64)) & 1);
+    }
+    return 100;
+}
+
+#else
+
+namespace distributed {
+
+    Session::Session(int&, char**&) {}
+
+    Session::~Session() {}
+
+    void Session::serve() {}
+}
+
+#endif
@@ -0,0 +1,212 @@
+#include <string>
+#include <iostream>
+#include <fstream>
+#include <stdexcept>
+#include <limits>
+#include <algorithm>
+
+#include "include/Engine.h"
+#include "include/Hash.h"
+#include "include/Renderer.h"
+#include "include/World.h"
+#include "include/PackedWorld.h"
+#include "include/TableWorld.h"
+#include "include/ByteWorld.h"
+#include "include/GenerationsWorld.h"
+#include "include/HashLife.h"
+#include "include/SparseWorld.h"
+#include "include/MappedWorld.h"
+#include "include/DistributedWorld.h"
+
+int Engine::world_size() {
+    return get_height() * get_width();
+}
+
+void Engine::advance(int generations) {
+    for (int i = 0; i < generations; i++) {
+        evolve();
+    }
+}
+
+void Engine::set_rule(const Rule& rule) {
+    if (!rule.is_life()) {
+        throw std::runtime_error(std::string("The ") + name() + " engine only runs B3/S23");
+    }
+}
+
+void Engine::set_torus(bool torus) {
+    if (torus) {
+        throw std::runtime_error(std::string("The ") + name() + " engine only runs on a bounded plane");
+    }
+}
+
+void Engine::print() {
+    // a renderer of its own has nothing on screen yet and draws the whole frame
+    Renderer().draw(*this);
+}
+
+uint64_t Engine::hash() {
+    uint64_t h = 0;
+    int height = get_height();
+    int width = get_width();
+    for (int i = 1; i <= height; i++) {
+        for (int j = 1; j <= width; j++) {
+            if (get(i, j) == 1) {
+                h ^= hashing::cell(i, j);
+            }
+        }
+    }
+    return h;
+}
+
+Stats Engine::stats() {
+    if (counted_valid) {
+        return counted;
+    }
+    Stats s;
+    s.min_row = s.min_col = std::numeric_limits<long long>::max();
+    s.max_row = s.max_col = std::numeric_limits<long long>::min();
+    int height = get_height();
+    int width = get_width();
+    for (int i = 1; i <= height; i++) {
+        for (int j = 1; j <= width; j++) {
+            if (get(i, j) == 1) {
+                s.population++;
+                s.min_row = std::min<long long>(s.min_row, i);
+                s.max_row = std::max<long long>(s.max_row, i);
+                s.min_col = std::min<long long>(s.min_col, j);
+                s.max_col = std::max<long long>(s.max_col, j);
+            }
+        }
+    }
+    if (s.population == 0) {
+        s = Stats();
+        s.births = s.deaths = -1;
+    }
+    return s;
+}
+
+void Engine::save(std::string f_path) {
+    int height = get_height();
+    int width = get_width();
+    std::ofstream File(f_path);
+    File << height << std::endl;
+    File << width << std::endl;
+    for (int i = 1; i <= height; i++) {
+        for (int j = 1; j <= width; j++) {
+            File << (get(i, j) == 1 ? 1 : 0) << " ";
+        }
+        File << std::endl;
+    }
+}
+
+void Engine::pack(uint64_t* rows) {
+    int height = get_height();
+    int width = get_width();
+    int words = (width + 63) / 64;
+    for (int i = 1; i <= height; i++) {
+        uint64_t* row = rows + size_t(i - 1) * words;
+        std::fill(row, row + words, 0);
+        for (int j = 1; j <= width; j++) {
+            row[(j - 1) / 64] |= uint64_t(get(i, j) == 1) << ((j - 1) % 64);
+        }
+    }
+}
+
+void Engine::unpack(const uint64_t* rows) {
+    int height = get_height();
+    int width = get_width();
+    int words = (width + 63) / 64;
+    for (int i = 1; i <= height; i++) {
+        const uint64_t* row = rows + size_t(i - 1) * words;
+        for (int k = 0; k < words; k++) {
+            // only the set bits of a word are visited
+            for (uint64_t bits = row[k]; bits != 0; bits &= bits - 1) {
+                set(i, 64 * k + __builtin_ctzll(bits) + 1);
+            }
+        }
+    }
+}
+
+// Row-major index over the inner grid
+void Engine::set(int index) {
+    int width = get_width();
+    if (index >= 0 && index < world_size()) {
+        set(index / width + 1, index % width + 1);
+    }
+}
+
+void Engine::set_run(int x, int y, int n) {
+    int first = std::max(y, 1);
+    int last = std::min<long long>((long long)y + n - 1, get_width());
+    for (int j = first; j <= last; j++) {
+        set(x, j);
+    }
+}
+
+int Engine::get(int index) {
+    int width = get_width();
+    if (index >= 0 && index < world_size()) {
+        return get(index / width + 1, index % width + 1);
+    }
+    return 100;
+}
+
+void check_engine_name(const std::string& name) {
+    static const char* const names[] = {"world", "packed", "table", "byte", "generations", "hashlife", "sparse",
+                                        "mapped", "distributed"};
+    if (std::find(std::begin(names), std::end(names), name) == std::end(names)) {
+        throw std::runtime_error("Unknown engine: " + name + " (available: world, packed, table, byte, generations, hashlife, sparse, mapped, distributed)");
+    }
+#ifndef HAVE_MPI
+    if (name == "distributed") {
+        throw std::runtime_error("Built without MPI, the distributed engine is not available");
+    }
+#endif
+}
+
+Engine* make_engine(const std::string& name, int height, int width) {
+    check_engine_name(name);
+    if (name == "world") {
+        return new World(height, width);
+    }
+    if (name == "packed") {
+        return new PackedWorld(height, width);
+    }
+    if (name == "table") {
+        return new TableWorld(height, width);
+    }
+    if (name == "byte") {
+        return new ByteWorld(height, width);
+    }
+    if (name == "generations") {
+        return new GenerationsWorld(height, width);
+    }
+    if (name == "hashlife") {
+        return new HashLife(height, width);
+    }
+    if (name == "sparse") {
+        return new SparseWorld(height, width);
+    }
+    if (name == "mapped") {
+        return new MappedWorld(MappedWorld::default_path, height, width);
+    }
+    if (name == "distributed") {
+#ifdef HAVE_MPI
+        return new DistributedWorld(height, width);
+#endif
+    }
+    throw std::runtime_error("Unknown engine: " + name);
+}
+
+void copy_cells(Engine& from, Engine& to) {
+    int height = from.get_height();
+    int width = from.get_width();
+    for (int i = 1; i <= height; i++) {
+        for (int j = 1; j <= width; j++) {
+            if (from.get(i, j) == 1) {
+                to.set(i, j);
+            }
+        }
+    }
+}
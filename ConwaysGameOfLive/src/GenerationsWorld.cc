@@ -0,0 +1,176 @@
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <fstream>
+#include <iostream>
+#include <stdexcept>
+#include <algorithm>
+
+#include "include/GenerationsWorld.h"
+#include "include/Renderer.h"
+#include "fvec/P4_I8vec16.h"
+
+GenerationsWorld::GenerationsWorld(): ByteWorld(), transitions(rule) {}
+
+GenerationsWorld::GenerationsWorld(int height, int width): ByteWorld(height, width), transitions(rule) {}
+
+GenerationsWorld::GenerationsWorld(std::string f_path): ByteWorld(), transitions(rule) {
+    std::ifstream f(f_path);
+    if (!f.is_open()) {
+        throw std::runtime_error("Cannot open " + f_path);
+    }
+    int h = 0;
+    int w = 0;
+    if (!(f >> h >> w) || h <= 0 || w <= 0) {
+        throw std::runtime_error("No height and width at the start of " + f_path);
+    }
+    static_cast<ByteWorld&>(*this) = ByteWorld(h, w);
+    for (int i = 1; i <= height; i++) {
+        for (int j = 1; j <= width; j++) {
+            int state = 0;
+            if (!(f >> state)) {
+                throw std::runtime_error("Not enough cells in " + f_path);
+            }
+            cell(i, j) = uint8_t(std::max(0, std::min(state, 255)));
+        }
+    }
+    rehash();
+}
+
+void GenerationsWorld::evolve() {
+    long long before = stats().population;
+    census::Tally tally;
+    if (bytelife::has_avx2()) {
+        state_hash = genlife::evolve_avx2(state1.data(), state2.data(), height, width, stride, transitions, tally);
+    } else {
+        state_hash = genlife::evolve_sse(state1.data(), state2.data(), height, width, stride, transitions, tally);
+    }
+    counted = tally.result(before);
+    counted_valid = true;
+    std::swap(state1, state2);
+}
+
+void GenerationsWorld::set_rule(const Rule& rule) {
+    this->rule = rule;
+    transitions = genlife::Transitions(rule);
+    for (int i = 1; i <= height; i++) {
+        for (int j = 1; j <= width; j++) {
+            if (cell(i, j) >= rule.states) {
+                cell(i, j) = 0;
+            }
+        }
+    }
+    rehash();
+    counted_valid = false;
+}
+
+void GenerationsWorld::set_state(int x, int y, int state) {
+    if (x > 0 && x <= height && y > 0 && y <= width && state >= 0 && state < rule.states) {
+        state_hash ^= bytelife::row_hash(&cell(x, 1), width, x);
+        cell(x, y) = uint8_t(state);
+        state_hash ^= bytelife::row_hash(&cell(x, 1), width, x);
+        counted_valid = false;
+    }
+}
+
+void GenerationsWorld::print() {
+    Renderer().draw(*this, rule.states);
+}
+
+void GenerationsWorld::save(std::string f_path) {
+    std::ofstream File(f_path);
+    File << height << std::endl;
+    File << width << std::endl;
+    for (int i = 1; i <= height; i++) {
+        for (int j = 1; j <= width; j++) {
+            File << int(cell(i, j)) << " ";
+        }
+        File << std::endl;
+    }
+}
+
+namespace genlife {
+
+    Transitions::Transitions(const Rule& rule) {
+        uint8_t dying = rule.states > 2 ? 2 : 0;
+        for (int n = 0; n < 16; n++) {
+            born[n] = n < 9 && ((rule.birth >> n) & 1) ? 1 : 0;
+            kept[n] = n < 9 && ((rule.survive >> n) & 1) ? 1 : dying;
+        }
+        states = uint8_t(rule.states);
+    }
+
+    uint64_t evolve_sse(const uint8_t* in, uint8_t* out, int height, int width, size_t stride, const Transitions& t, census::Tally& tally) {
+        const I8vec16 zero, one(1), all(255), states(t.states);
+        // the neighbour counts that give birth or keep a cell, SSE2 has no byte shuffle
+        int born_counts[9];
+        int kept_counts[9];
+        int n_born = 0;
+        int n_kept = 0;
+        for (int n = 0; n < 9; n++) {
+            if (t.born[n] == 1) born_counts[n_born++] = n;
+            if (t.kept[n] == 1) kept_counts[n_kept++] = n;
+        }
+        const I8vec16 dying(t.kept[9]);
+        uint64_t h = 0;
+        census::Tally counts;
+        uint8_t lanes[i8vecLen];
+        bytelife::last_lanes(lanes, i8vecLen, width, 0xff);
+        const I8vec16 last_lanes = I8vec16::load(lanes);
+        // one contiguous band of rows per thread
+        #pragma omp parallel for schedule(static) reduction(^:h) reduction(tally:counts)
+        for (int i = 1; i <= height; i++) {
+            const uint8_t* mid = in + size_t(i) * stride + ByteWorld::halo;
+            const uint8_t* up = mid - stride;
+            const uint8_t* dn = mid + stride;
+            uint8_t* res = out + size_t(i) * stride + ByteWorld::halo;
+            __m128i population = zero;
+            __m128i changes = zero;
+            for (int j0 = 0; j0 < width; j0 += bytelife::count_block * i8vecLen) {
+                int j1 = std::min(width, j0 + bytelife::count_block * i8vecLen);
+                // every living or changed cell adds a mask of -1
+                I8vec16 neg_living, neg_changed;
+                for (int j = j0; j < j1; j += i8vecLen) {
+                    I8vec16 state = I8vec16::load(mid + j);
+                    // every living neighbour adds a mask of -1
+                    I8vec16 count = zero - ((I8vec16::load(up + j - 1) == one) + (I8vec16::load(up + j) == one)
+                                          + (I8vec16::load(up + j + 1) == one) + (I8vec16::load(mid + j - 1) == one)
+                                          + (I8vec16::load(mid + j + 1) == one) + (I8vec16::load(dn + j - 1) == one)
+                                          + (I8vec16::load(dn + j) == one) + (I8vec16::load(dn + j + 1) == one));
+                    I8vec16 born, kept;
+                    for (int k = 0; k < n_born; k++) {
+                        born = born | (count == I8vec16(uint8_t(born_counts[k])));
+                    }
+                    for (int k = 0; k < n_kept; k++) {
+                        kept = kept | (count == I8vec16(uint8_t(kept_counts[k])));
+                    }
+                    kept = (kept & one) | ((kept ^ all) & dying);
+                    I8vec16 older = state + one;
+                    older = older & ((older == states) ^ all);
+                    I8vec16 dead = state == zero;
+                    I8vec16 alive = state == one;
+                    // lanes right of the last column stay dead, so they count as nothing
+                    I8vec16 next = ((dead & born & one) | (alive & kept) | (((dead | alive) ^ all) & older))
+                                 & (j + i8vecLen <= width ? all : last_lanes);
+                    store(res + j, next);
+                    I8vec16 living = next == one;
+                    neg_living = neg_living + living;
+                    neg_changed = neg_changed + (living ^ alive);
+                }
+                population = _mm_add_epi64(population, _mm_sad_epu8(zero - neg_living, zero));
+                changes = _mm_add_epi64(changes, _mm_sad_epu8(zero - neg_changed, zero));
+            }
+            // the last vector may have spilled into the right halo
+            std::memset(res + width, 0, stride - ByteWorld::halo - width);
+            h ^= bytelife::row_hash(res, width, i);
+            long long row_population = bytelife::lane_sum(population);
+            if (row_population > 0) {
+                counts.population += row_population;
+                bytelife::span_row(counts, i, res, width);
+            }
+            counts.changes += bytelife::lane_sum(changes);
+        }
+        tally = counts;
+        return h;
+    }
+}
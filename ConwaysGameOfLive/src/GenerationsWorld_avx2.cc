@@ -0,0 +1,79 @@
+// Compiled with -mavx2, only called when the CPU supports it
+#include <cstdint>
+#include <cstring>
+#include <algorithm>
+#include <immintrin.h>
+
+#include "include/GenerationsWorld.h"
+
+namespace genlife {
+
+    uint64_t evolve_avx2(const uint8_t* in, uint8_t* out, int height, int width, size_t stride, const Transitions& t, census::Tally& tally) {
+#ifdef __AVX2__
+        uint64_t h = 0;
+        census::Tally counts;
+        const __m256i zero = _mm256_setzero_si256();
+        const __m256i one = _mm256_set1_epi8(1);
+        const __m256i states = _mm256_set1_epi8(char(t.states));
+        // the shuffle looks up 16 bytes per 128 bit lane, so both lanes get the table
+        const __m256i born = _mm256_broadcastsi128_si256(_mm_loadu_si128(reinterpret_cast<const __m128i*>(t.born)));
+        const __m256i kept = _mm256_broadcastsi128_si256(_mm_loadu_si128(reinterpret_cast<const __m128i*>(t.kept)));
+        uint8_t lanes[32];
+        bytelife::last_lanes(lanes, 32, width, 0xff);
+        const __m256i last_lanes = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(lanes));
+        const __m256i all = _mm256_set1_epi8(-1);
+        // one contiguous band of rows per thread
+        #pragma omp parallel for schedule(static) reduction(^:h) reduction(tally:counts)
+        for (int i = 1; i <= height; i++) {
+            const uint8_t* mid = in + size_t(i) * stride + ByteWorld::halo;
+            const uint8_t* up = mid - stride;
+            const uint8_t* dn = mid + stride;
+            uint8_t* res = out + size_t(i) * stride + ByteWorld::halo;
+            __m256i population = zero;
+            __m256i changes = zero;
+            for (int j0 = 0; j0 < width; j0 += bytelife::count_block * 32) {
+                int j1 = std::min(width, j0 + bytelife::count_block * 32);
+                // every living or changed cell adds a mask of -1
+                __m256i neg_living = zero;
+                __m256i neg_changed = zero;
+                for (int j = j0; j < j1; j += 32) {
+#define LIVING(p) _mm256_cmpeq_epi8(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(p)), one)
+                    __m256i state = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(mid + j));
+                    // every living neighbour adds a mask of -1
+                    __m256i neg = _mm256_add_epi8(_mm256_add_epi8(LIVING(up + j - 1), LIVING(up + j)),
+                                                  _mm256_add_epi8(LIVING(up + j + 1), LIVING(mid + j - 1)));
+                    neg = _mm256_add_epi8(neg, _mm256_add_epi8(_mm256_add_epi8(LIVING(mid + j + 1), LIVING(dn + j - 1)),
+                                                               _mm256_add_epi8(LIVING(dn + j), LIVING(dn + j + 1))));
+#undef LIVING
+                    __m256i count = _mm256_sub_epi8(zero, neg);
+                    __m256i alive = _mm256_cmpeq_epi8(state, one);
+                    __m256i older = _mm256_add_epi8(state, one);
+                    older = _mm256_andnot_si256(_mm256_cmpeq_epi8(older, states), older);
+                    __m256i next = _mm256_blendv_epi8(older, _mm256_shuffle_epi8(kept, count), alive);
+                    next = _mm256_blendv_epi8(next, _mm256_shuffle_epi8(born, count), _mm256_cmpeq_epi8(state, zero));
+                    // lanes right of the last column stay dead, so they count as nothing
+                    next = _mm256_and_si256(next, j + 32 <= width ? all : last_lanes);
+                    _mm256_storeu_si256(reinterpret_cast<__m256i*>(res + j), next);
+                    __m256i living = _mm256_cmpeq_epi8(next, one);
+                    neg_living = _mm256_add_epi8(neg_living, living);
+                    neg_changed = _mm256_add_epi8(neg_changed, _mm256_xor_si256(living, alive));
+                }
+                population = _mm256_add_epi64(population, _mm256_sad_epu8(_mm256_sub_epi8(zero, neg_living), zero));
+                changes = _mm256_add_epi64(changes, _mm256_sad_epu8(_mm256_sub_epi8(zero, neg_changed), zero));
+            }
+            // the last vector may have spilled into the right halo
+            std::memset(res + width, 0, stride - ByteWorld::halo - width);
+            h ^= bytelife::row_hash(res, width, i);
+            if (!_mm256_testz_si256(population, population)) {
+                counts.population += bytelife::lane_sum(population);
+                bytelife::span_row(counts, i, res, width);
+            }
+            counts.changes += bytelife::lane_sum(changes);
+        }
+        tally = counts;
+        return h;
+#else
+        return evolve_sse(in, out, height, width, stride, t, tally);
+#endif
+    }
+}
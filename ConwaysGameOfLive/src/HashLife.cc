@@ -0,0 +1,410 @@
+#include <cstdint>
+#include <vector>
+#include <random>
+#include <string>
+#include <algorithm>
+#include <stdexcept>
+
+#include "include/HashLife.h"
+#include "include/Hash.h"
+
+const uint32_t HashLife::none;
+
+HashLife::HashLife(): HashLife(0, 0) {}
+
+HashLife::HashLife(int height, int width, size_t max_nodes): height(height), width(width), max_nodes(max_nodes) {
+    Node dead = {0, 0, 0, 0, none, none, 0, 0, 0};
+    Node alive = {1, 1, 1, 1, none, none, 1, 1, 0};
+    nodes.push_back(dead);
+    nodes.push_back(alive);
+    buckets.assign(1 << 10, none);
+    empties.push_back(0);
+    root = empty(3);
+    cover(height - 1, width - 1);
+}
+
+int HashLife::get_height() {
+    return height;
+}
+
+int HashLife::get_width() {
+    return width;
+}
+
+uint32_t HashLife::join(uint32_t nw, uint32_t ne, uint32_t sw, uint32_t se) {
+    uint64_t h = nw * 0x9E3779B97F4A7C15ULL + ne * 0xC2B2AE3D27D4EB4FULL + sw * 0x165667B19E3779F9ULL + se * 0x27D4EB2F165667C5ULL;
+    h ^= h >> 29;
+    size_t idx = h & (buckets.size() - 1);
+    for (uint32_t id = buckets[idx]; id != none; id = nodes[id].next) {
+        const Node& n = nodes[id];
+        if (n.nw == nw && n.ne == ne && n.sw == sw && n.se == se) {
+            return id;
+        }
+    }
+    Node n = {nw, ne, sw, se, none, buckets[idx],
+              nodes[nw].population + nodes[ne].population + nodes[sw].population + nodes[se].population,
+              hashing::mix64(nodes[nw].hash + 3 * hashing::mix64(nodes[ne].hash + 3 * hashing::mix64(nodes[sw].hash + 3 * nodes[se].hash))),
+              uint8_t(nodes[nw].level + 1)};
+    uint32_t id;
+    if (free_ids.empty()) {
+        id = nodes.size();
+        nodes.push_back(n);
+    } else {
+        id = free_ids.back();
+        free_ids.pop_back();
+        nodes[id] = n;
+    }
+    buckets[idx] = id;
+    if (node_count() > buckets.size()) {
+        rehash(buckets.size() * 2);
+    }
+    return id;
+}
+
+void HashLife::rehash(size_t n_buckets) {
+    buckets.assign(n_buckets, none);
+    for (uint32_t id = 2; id < nodes.size(); id++) {
+        Node& n = nodes[id];
+        if (n.level == 0xff) {
+            continue; // free
+        }
+        uint64_t h = n.nw * 0x9E3779B97F4A7C15ULL + n.ne * 0xC2B2AE3D27D4EB4FULL + n.sw * 0x165667B19E3779F9ULL + n.se * 0x27D4EB2F165667C5ULL;
+        h ^= h >> 29;
+        size_t idx = h & (n_buckets - 1);
+        n.next = buckets[idx];
+        buckets[idx] = id;
+    }
+}
+
+uint32_t HashLife::empty(int level) {
+    while ((int)empties.size() <= level) {
+        uint32_t e = empties.back();
+        empties.push_back(join(e, e, e, e));
+    }
+    return empties[level];
+}
+
+uint32_t HashLife::centre(uint32_t n) {
+    Node c = nodes[n];
+    return join(nodes[c.nw].se, nodes[c.ne].sw, nodes[c.sw].ne, nodes[c.se].nw);
+}
+
+uint32_t HashLife::expand(uint32_t n) {
+    Node c = nodes[n];
+    uint32_t e = empty(c.level - 1);
+    return join(join(e, e, e, c.nw), join(e, e, c.ne, e),
+                join(e, c.sw, e, e), join(c.se, e, e, e));
+}
+
+// 4x4 cells to the centre 2x2 one generation later
+uint32_t HashLife::base_result(uint32_t n) {
+    Node c = nodes[n];
+    uint32_t quads[4] = {c.nw, c.ne, c.sw, c.se};
+    int cells[4][4];
+    for (int q = 0; q < 4; q++) {
+        const Node& s = nodes[quads[q]];
+        int r = (q / 2) * 2;
+        int col = (q % 2) * 2;
+        cells[r][col] = s.nw;
+        cells[r][col + 1] = s.ne;
+        cells[r + 1][col] = s.sw;
+        cells[r + 1][col + 1] = s.se;
+    }
+    uint32_t next[4];
+    for (int k = 0; k < 4; k++) {
+        int i = 1 + k / 2;
+        int j = 1 + k % 2;
+        int n_sum = cells[i-1][j-1] + cells[i-1][j] + cells[i-1][j+1] + cells[i][j-1]
+                  + cells[i][j+1] + cells[i+1][j-1] + cells[i+1][j] + cells[i+1][j+1];
+        next[k] = (n_sum == 3) | ((n_sum == 2) & cells[i][j]);
+    }
+    return join(next[0], next[1], next[2], next[3]);
+}
+
+uint32_t HashLife::result(uint32_t n) {
+    if (nodes[n].result != none) {
+        return nodes[n].result;
+    }
+    // every id this call still needs after a call that may collect goes on held
+    size_t depth = held.size();
+    held.push_back(n);
+    reclaim();
+    Node c = nodes[n];
+    uint32_t r;
+    if (c.level == 2) {
+        r = base_result(n);
+    } else {
+        // the 4x4 grandchildren, g[i][j] is row i, column j
+        uint32_t g[4][4];
+        uint32_t quads[4] = {c.nw, c.ne, c.sw, c.se};
+        for (int q = 0; q < 4; q++) {
+            const Node& s = nodes[quads[q]];
+            int i = (q / 2) * 2;
+            int j = (q % 2) * 2;
+            g[i][j] = s.nw;
+            g[i][j + 1] = s.ne;
+            g[i + 1][j] = s.sw;
+            g[i + 1][j + 1] = s.se;
+        }
+        // nine overlapping subnodes of level k-1, advanced by a full half step or only centred
+        bool full = c.level - 2 <= step_exp;
+        uint32_t m[3][3];
+        for (int i = 0; i < 3; i++) {
+            for (int j = 0; j < 3; j++) {
+                uint32_t sub = join(g[i][j], g[i][j + 1], g[i + 1][j], g[i + 1][j + 1]);
+                m[i][j] = full ? result(sub) : centre(sub);
+                held.push_back(m[i][j]);
+            }
+        }
+        uint32_t nw = result(join(m[0][0], m[0][1], m[1][0], m[1][1]));
+        held.push_back(nw);
+        uint32_t ne = result(join(m[0][1], m[0][2], m[1][1], m[1][2]));
+        held.push_back(ne);
+        uint32_t sw = result(join(m[1][0], m[1][1], m[2][0], m[2][1]));
+        held.push_back(sw);
+        uint32_t se = result(join(m[1][1], m[1][2], m[2][1], m[2][2]));
+        r = join(nw, ne, sw, se);
+    }
+    held.resize(depth);
+    nodes[n].result = r;
+    return r;
+}
+
+uint32_t HashLife::set_cell(uint32_t n, int64_t row, int64_t col) {
+    Node c = nodes[n];
+    if (c.level == 0) {
+        return 1;
+    }
+    int64_t half = int64_t(1) << (c.level - 1);
+    if (row < half) {
+        if (col < half) {
+            return join(set_cell(c.nw, row, col), c.ne, c.sw, c.se);
+        }
+        return join(c.nw, set_cell(c.ne, row, col - half), c.sw, c.se);
+    }
+    if (col < half) {
+        return join(c.nw, c.ne, set_cell(c.sw, row - half, col), c.se);
+    }
+    return join(c.nw, c.ne, c.sw, set_cell(c.se, row - half, col - half));
+}
+
+int HashLife::get_cell(uint32_t n, int64_t row, int64_t col) {
+    while (nodes[n].level > 0) {
+        if (nodes[n].population == 0) {
+            return 0;
+        }
+        int64_t half = int64_t(1) << (nodes[n].level - 1);
+        if (row < half) {
+            n = col < half ? nodes[n].nw : nodes[n].ne;
+        } else {
+            n = col < half ? nodes[n].sw : nodes[n].se;
+            row -= half;
+        }
+        if (col >= half) {
+            col -= half;
+        }
+    }
+    return n;
+}
+
+void HashLife::cover(int64_t row, int64_t col) {
+    while (true) {
+        int64_t half = int64_t(1) << (nodes[root].level - 1);
+        if (row >= -half && row < half && col >= -half && col < half) {
+            return;
+        }
+        root = expand(root);
+    }
+}
+
+void HashLife::shrink() {
+    while (nodes[root].level > 3) {
+        uint32_t c = centre(root);
+        if (nodes[c].population != nodes[root].population) {
+            return;
+        }
+        root = c;
+    }
+}
+
+void HashLife::collect() {
+    std::vector<char> marked(nodes.size(), 0);
+    std::vector<uint32_t> stack(empties.begin(), empties.end());
+    stack.insert(stack.end(), held.begin(), held.end());
+    stack.push_back(root);
+    marked[0] = marked[1] = 1;
+    while (!stack.empty()) {
+        uint32_t id = stack.back();
+        stack.pop_back();
+        if (marked[id]) {
+            continue;
+        }
+        marked[id] = 1;
+        const Node& n = nodes[id];
+        stack.push_back(n.nw);
+        stack.push_back(n.ne);
+        stack.push_back(n.sw);
+        stack.push_back(n.se);
+    }
+    for (uint32_t id = 2; id < nodes.size(); id++) {
+        Node& n = nodes[id];
+        if (n.level == 0xff) {
+            continue;
+        }
+        if (!marked[id]) {
+            n.level = 0xff;
+            free_ids.push_back(id);
+        } else if (n.result != none && !marked[n.result]) {
+            n.result = none;
+        }
+    }
+    rehash(buckets.size());
+    gc_runs++;
+}
+
+void HashLife::reclaim() {
+    if (node_count() < max_nodes) {
+        return;
+    }
+    collect();
+    // a pool that stays nearly full would be collected again after a few joins
+    if (node_count() > max_nodes - max_nodes / 4) {
+        held.clear();
+        throw std::runtime_error("HashLife needs more than three quarters of its " + std::to_string(max_nodes)
+                                 + " nodes for this pattern");
+    }
+}
+
+void HashLife::step_pow2(int exp) {
+    if (exp != step_exp) {
+        for (Node& n : nodes) {
+            n.result = none;
+        }
+        step_exp = exp;
+    }
+    // the pattern has to sit in the centre with room to grow by 2^exp cells on each side
+    while (nodes[root].level < exp + 3 || nodes[centre(root)].population != nodes[root].population) {
+        root = expand(root);
+    }
+    root = expand(root);
+    root = result(root);
+    shrink();
+}
+
+void HashLife::jump(uint64_t generations) {
+    for (int exp = 0; exp < 64; exp++) {
+        if ((generations >> exp) & 1) {
+            step_pow2(exp);
+        }
+    }
+    cover(height - 1, width - 1);
+}
+
+void HashLife::evolve() {
+    jump(1);
+}
+
+int64_t HashLife::edge(uint32_t n, int side, std::unordered_map<uint32_t, int64_t>& memo) {
+    if (nodes[n].level == 0) {
+        return 0;
+    }
+    auto it = memo.find(n);
+    if (it != memo.end()) {
+        return it->second;
+    }
+    const Node& c = nodes[n];
+    // the two children along the side first, the two behind them half a node further
+    static const int order[4][4] = {{0, 1, 2, 3}, {2, 3, 0, 1}, {0, 2, 1, 3}, {1, 3, 0, 2}};
+    uint32_t child[4] = {c.nw, c.ne, c.sw, c.se};
+    int64_t half = int64_t(1) << (c.level - 1);
+    int64_t best = -1;
+    for (int pass = 0; pass < 2 && best < 0; pass++) {
+        for (int k = 0; k < 2; k++) {
+            uint32_t q = child[order[side][2 * pass + k]];
+            if (nodes[q].population > 0) {
+                int64_t d = pass * half + edge(q, side, memo);
+                best = best < 0 ? d : std::min(best, d);
+            }
+        }
+    }
+    memo[n] = best;
+    return best;
+}
+
+Stats HashLife::stats() {
+    Stats s;
+    s.population = nodes[root].population;
+    if (s.population > 0) {
+        // the root covers plane cells [-half, half) and (1, 1) shows plane cell (0, 0)
+        int64_t half = int64_t(1) << (nodes[root].level - 1);
+        int64_t d[4];
+        for (int side = 0; side < 4; side++) {
+            std::unordered_map<uint32_t, int64_t> memo;
+            d[side] = edge(root, side, memo);
+        }
+        s.min_row = 1 - half + d[0];
+        s.max_row = half - d[1];
+        s.min_col = 1 - half + d[2];
+        s.max_col = half - d[3];
+    }
+    return s;
+}
+
+size_t HashLife::memory() {
+    return nodes.capacity() * sizeof(Node) + (buckets.capacity() + free_ids.capacity() + empties.capacity()) * sizeof(uint32_t);
+}
+
+uint64_t HashLife::hash() {
+    // the hash of the smallest root holding the pattern, salted with its level
+    shrink();
+    return nodes[root].hash ^ hashing::mix64(nodes[root].level);
+}
+
+void HashLife::random(double probability) {
+    std::random_device rd;
+    std::mt19937 gen(rd());
+    std::bernoulli_distribution dist(probability);
+    // the whole plane is cleared first, like the dense engines overwrite every cell
+    root = empty(nodes[root].level);
+    for (int i = 1; i <= height; i++) {
+        for (int j = 1; j <= width; j++) {
+            if (dist(gen)) {
+                set(i, j);
+            }
+        }
+    }
+}
+
+void HashLife::set(int x, int y) {
+    if (x > 0 && x <= height && y > 0 && y <= width) {
+        reclaim();
+        cover(x - 1, y - 1);
+        int64_t half = int64_t(1) << (nodes[root].level - 1);
+        root = set_cell(root, x - 1 + half, y - 1 + half);
+    }
+}
+
+int HashLife::get(int x, int y) {
+    if (x > 0 && x <= height && y > 0 && y <= width) {
+        int64_t half = int64_t(1) << (nodes[root].level - 1);
+        int64_t row = x - 1 + half;
+        int64_t col = y - 1 + half;
+        if (row < 0 || col < 0 || row >= 2 * half || col >= 2 * half) {
+            return 0;
+        }
+        return get_cell(root, row, col);
+    }
+    return 100;
+}
+
+uint64_t HashLife::population() {
+    return nodes[root].population;
+}
+
+size_t HashLife::node_count() {
+    return nodes.size() - free_ids.size();
+}
+
+size_t HashLife::collections() {
+    return gc_runs;
+}
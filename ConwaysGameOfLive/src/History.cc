@@ -0,0 +1,117 @@
+#include <string>
+#include <stdexcept>
+#include <algorithm>
+
+#include "include/History.h"
+#include "include/Snapshot.h"
+
+History::History(size_t budget, long long interval) : budget(budget), interval(std::max(interval, 1LL)) {}
+
+void History::truncate(long long generation) {
+    bool removed = false;
+    while (!entries.empty() && entries.back().generation >= generation) {
+        bytes -= sizeof(Entry) + entries.back().data.size() * sizeof(uint64_t);
+        keys -= entries.back().key;
+        entries.pop_back();
+        removed = true;
+    }
+    if (removed) {
+        // previous is no longer the generation before the next one recorded
+        previous_generation = -1;
+    }
+}
+
+void History::record(Engine& world, long long generation) {
+    if (world.get_height() != height || world.get_width() != width) {
+        entries.clear();
+        bytes = 0;
+        keys = 0;
+        height = world.get_height();
+        width = world.get_width();
+        previous_generation = -1;
+    }
+    size_t n = size_t(height) * ((size_t(width) + 63) / 64);
+    current.resize(n);
+    world.pack(current.data());
+    if (generation == previous_generation && !entries.empty() && entries.back().generation == generation
+        && current == previous) {
+        // recorded before and not edited since
+        return;
+    }
+    truncate(generation);
+
+    Entry entry;
+    entry.generation = generation;
+    bool chained = previous_generation == generation - 1 && !entries.empty() && entries.back().generation == generation - 1;
+    entry.key = !chained || generation - key_generation >= interval;
+    if (!entry.key) {
+        scratch.resize(n);
+        for (size_t i = 0; i < n; i++) {
+            scratch[i] = current[i] ^ previous[i];
+        }
+    } else {
+        key_generation = generation;
+    }
+    const std::vector<uint64_t>& words = entry.key ? current : scratch;
+    rle::encode(words, entry.data);
+    // a busy soup changes nearly every word and is kept as it is
+    entry.raw = entry.data.size() >= n;
+    if (entry.raw) {
+        entry.data = words;
+    }
+    entry.data.shrink_to_fit();
+    bytes += sizeof(Entry) + entry.data.size() * sizeof(uint64_t);
+    keys += entry.key;
+    entries.push_back(std::move(entry));
+    previous.swap(current);
+    previous_generation = generation;
+
+    // the deltas after the oldest keyframe are useless without it, so they go together
+    while (bytes > budget && keys > 1) {
+        do {
+            bytes -= sizeof(Entry) + entries.front().data.size() * sizeof(uint64_t);
+            keys -= entries.front().key;
+            entries.pop_front();
+        } while (!entries.front().key);
+    }
+}
+
+void History::decode(const Entry& entry, std::vector<uint64_t>& words) const {
+    if (entry.raw) {
+        std::copy(entry.data.begin(), entry.data.end(), words.begin());
+    } else {
+        rle::decode(entry.data.data(), entry.data.size(), words.data(), words.size());
+    }
+}
+
+bool History::has(long long generation) const {
+    auto it = std::lower_bound(entries.begin(), entries.end(), generation,
+                               [](const Entry& e, long long g) { return e.generation < g; });
+    return it != entries.end() && it->generation == generation;
+}
+
+void History::restore(long long generation, Engine& world) {
+    if (world.get_height() != height || world.get_width() != width) {
+        throw std::runtime_error("The history was recorded on a world of another size");
+    }
+    auto it = std::lower_bound(entries.begin(), entries.end(), generation,
+                               [](const Entry& e, long long g) { return e.generation < g; });
+    if (it == entries.end() || it->generation != generation) {
+        throw std::runtime_error("Generation " + std::to_string(generation) + " is not in the history");
+    }
+    auto key = it;
+    while (!key->key) {
+        --key;
+    }
+    size_t n = size_t(height) * ((size_t(width) + 63) / 64);
+    current.resize(n);
+    scratch.resize(n);
+    decode(*key, current);
+    for (auto delta = key + 1; delta <= it; ++delta) {
+        decode(*delta, scratch);
+        for (size_t i = 0; i < n; i++) {
+            current[i] ^= scratch[i];
+        }
+    }
+    world.unpack(current.data());
+}
@@ -0,0 +1,271 @@
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <random>
+#include <stdexcept>
+#include <algorithm>
+
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include "include/MappedWorld.h"
+#include "include/BitLife.h"
+#include "include/Hash.h"
+#include "include/Census.h"
+
+std::string MappedWorld::default_path = "GameState.map";
+
+MappedWorld::MappedWorld(const std::string& path, int height, int width)
+    : height(height), width(width), path(path) {
+    if (height <= 0 || width <= 0) {
+        throw std::runtime_error("The mapped engine needs at least one row and one column");
+    }
+    words = (width + 63) / 64;
+    size_t payload = size_t(height) * words * sizeof(uint64_t);
+    size = sizeof(SnapshotHeader) + 2 * payload;
+    std::string tmp = path + ".tmp";
+    fd = open(tmp.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644);
+    // the file is sparse, both generations start out as zero pages
+    if (fd < 0 || ftruncate(fd, off_t(size)) != 0) {
+        if (fd >= 0) {
+            close(fd);
+            unlink(tmp.c_str());
+        }
+        throw std::runtime_error("Cannot create " + tmp);
+    }
+    attach();
+    std::memset(head, 0, sizeof(SnapshotHeader));
+    std::memcpy(head->magic, snapshot_magic, sizeof(head->magic));
+    head->version = SnapshotHeader::current;
+    head->height = height;
+    head->width = width;
+    describe(0, Rule(), false);
+    head->payload = payload;
+    if (std::rename(tmp.c_str(), path.c_str()) != 0) {
+        munmap(map, size);
+        close(fd);
+        unlink(tmp.c_str());
+        throw std::runtime_error("Cannot replace " + path);
+    }
+}
+
+MappedWorld::MappedWorld(const std::string& path) : path(path) {
+    {
+        SnapshotFile s(path);
+        if (s.compressed()) {
+            throw std::runtime_error(path + " is run-length encoded, only raw snapshots can be mapped");
+        }
+        if (!s.rule().is_life() || s.torus()) {
+            throw std::runtime_error("The mapped engine only runs B3/S23 on a bounded plane");
+        }
+        height = s.height();
+        width = s.width();
+    }
+    words = (width + 63) / 64;
+    size = sizeof(SnapshotHeader) + 2 * size_t(height) * words * sizeof(uint64_t);
+    fd = open(path.c_str(), O_RDWR);
+    struct stat st;
+    if (fd < 0 || fstat(fd, &st) != 0) {
+        if (fd >= 0) {
+            close(fd);
+        }
+        throw std::runtime_error("Cannot open " + path + " for writing");
+    }
+    // a snapshot saved by another engine has one set of rows, the second goes behind it
+    if (size_t(st.st_size) < size && ftruncate(fd, off_t(size)) != 0) {
+        close(fd);
+        throw std::runtime_error("Cannot make room for the next generation in " + path);
+    }
+    attach();
+    rehash();
+}
+
+MappedWorld::~MappedWorld() {
+    munmap(map, size);
+    close(fd);
+}
+
+void MappedWorld::attach() {
+    map = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    if (map == MAP_FAILED) {
+        map = nullptr;
+        close(fd);
+        throw std::runtime_error("Cannot map " + path);
+    }
+    madvise(map, size, MADV_SEQUENTIAL);
+    head = static_cast<SnapshotHeader*>(map);
+    int rest = width % 64;
+    last_mask = rest == 0 ? ~uint64_t(0) : (uint64_t(1) << rest) - 1;
+    // 4 MiB of rows per stripe
+    stripe = std::max(1, int((size_t(4) << 20) / (size_t(words) * sizeof(uint64_t))));
+    zeros.assign(words, 0);
+}
+
+uint64_t* MappedWorld::current() {
+    uint64_t* rows = reinterpret_cast<uint64_t*>(head + 1);
+    return (head->flags & SnapshotHeader::swapped) ? rows + size_t(height) * words : rows;
+}
+
+uint64_t* MappedWorld::next() {
+    uint64_t* rows = reinterpret_cast<uint64_t*>(head + 1);
+    return (head->flags & SnapshotHeader::swapped) ? rows : rows + size_t(height) * words;
+}
+
+int MappedWorld::get_height() {
+    return height;
+}
+
+int MappedWorld::get_width() {
+    return width;
+}
+
+void MappedWorld::prefetch(const uint64_t* rows, long long first, long long last) {
+    first = std::max(first, 1LL);
+    last = std::min(last, (long long)height);
+    if (first > last) {
+        return;
+    }
+    static const uintptr_t page = uintptr_t(sysconf(_SC_PAGESIZE));
+    uintptr_t from = reinterpret_cast<uintptr_t>(rows + size_t(first - 1) * words) & ~(page - 1);
+    uintptr_t to = reinterpret_cast<uintptr_t>(rows + size_t(last) * words);
+    madvise(reinterpret_cast<void*>(from), to - from, MADV_WILLNEED);
+}
+
+void MappedWorld::write_back(const uint64_t* rows, int first, int last) {
+    const char* base = static_cast<const char*>(map);
+    off_t from = reinterpret_cast<const char*>(rows + size_t(first - 1) * words) - base;
+    off_t to = reinterpret_cast<const char*>(rows + size_t(last) * words) - base;
+#ifdef SYNC_FILE_RANGE_WRITE
+    // starts the writeback of the dirty pages without waiting for it
+    sync_file_range(fd, from, to - from, SYNC_FILE_RANGE_WRITE);
+#else
+    static const off_t page = off_t(sysconf(_SC_PAGESIZE));
+    msync(static_cast<char*>(map) + (from & ~(page - 1)), size_t(to - (from & ~(page - 1))), MS_ASYNC);
+#endif
+}
+
+void MappedWorld::evolve() {
+    long long before = stats().population;
+    const uint64_t* in = current();
+    uint64_t* out = next();
+    const uint64_t* zero = zeros.data();
+    int n = words;
+    uint64_t h = 0;
+    census::Tally tally;
+    prefetch(in, 1, stripe + 1);
+    for (int first = 1; first <= height; first += stripe) {
+        int last = std::min(first + stripe - 1, height);
+        // the next stripe and the row below it are paged in while this one is computed
+        prefetch(in, last + 1, (long long)last + stripe + 1);
+        #pragma omp parallel for schedule(static) reduction(^:h) reduction(tally:tally)
+        for (int i = first; i <= last; i++) {
+            const uint64_t* mid = in + size_t(i - 1) * n;
+            const uint64_t* up = i > 1 ? mid - n : zero;
+            const uint64_t* dn = i < height ? mid + n : zero;
+            uint64_t* row = out + size_t(i - 1) * n;
+            uint64_t acc = 0;
+            for (int k = 0; k < n; k++) {
+                // the words left of the first and right of the last are the dead border
+                int l = k > 0 ? k - 1 : -1;
+                int r = k + 1 < n ? k + 1 : -1;
+                uint64_t cells = bitlife::step(l < 0 ? 0 : up[l], up[k], r < 0 ? 0 : up[r],
+                                               l < 0 ? 0 : mid[l], mid[k], r < 0 ? 0 : mid[r],
+                                               l < 0 ? 0 : dn[l], dn[k], r < 0 ? 0 : dn[r]);
+                row[k] = r < 0 ? cells & last_mask : cells;
+                acc = hashing::fold(acc, row[k]);
+            }
+            h ^= hashing::row(i, acc);
+            tally.words(i, 1, row, mid, n);
+        }
+        write_back(out, first, last);
+    }
+    // the header names the new rows current only once they are all written
+    head->flags ^= SnapshotHeader::swapped;
+    head->generation++;
+    state_hash = h;
+    counted = tally.result(before);
+    counted_valid = true;
+}
+
+uint64_t MappedWorld::hash() {
+    return state_hash;
+}
+
+size_t MappedWorld::memory() {
+    return size;
+}
+
+uint64_t MappedWorld::row_hash(int i) {
+    const uint64_t* row = current() + size_t(i - 1) * words;
+    uint64_t acc = 0;
+    for (int k = 0; k < words; k++) {
+        acc = hashing::fold(acc, row[k]);
+    }
+    return hashing::row(i, acc);
+}
+
+void MappedWorld::rehash() {
+    state_hash = 0;
+    for (int i = 1; i <= height; i++) {
+        state_hash ^= row_hash(i);
+    }
+    counted_valid = false;
+}
+
+void MappedWorld::random(double probability) {
+    std::random_device rd;
+    std::mt19937 gen(rd());
+    std::bernoulli_distribution dist(probability);
+    uint64_t* rows = current();
+    for (int i = 1; i <= height; i++) {
+        uint64_t* row = rows + size_t(i - 1) * words;
+        std::fill(row, row + words, 0);
+        for (int j = 1; j <= width; j++) {
+            if (dist(gen)) {
+                row[(j - 1) / 64] |= uint64_t(1) << ((j - 1) % 64);
+            }
+        }
+    }
+    rehash();
+}
+
+void MappedWorld::pack(uint64_t* rows) {
+    const uint64_t* from = current();
+    std::copy(from, from + size_t(height) * words, rows);
+}
+
+void MappedWorld::unpack(const uint64_t* rows) {
+    uint64_t* to = current();
+    std::copy(rows, rows + size_t(height) * words, to);
+    for (int i = 1; i <= height; i++) {
+        // bits right of the last column would be born into the border
+        to[size_t(i) * words - 1] &= last_mask;
+    }
+    rehash();
+}
+
+void MappedWorld::set(int x, int y) {
+    if (x > 0 && x <= height && y > 0 && y <= width) {
+        state_hash ^= row_hash(x);
+        current()[size_t(x - 1) * words + (y - 1) / 64] |= uint64_t(1) << ((y - 1) % 64);
+        state_hash ^= row_hash(x);
+        counted_valid = false;
+    }
+}
+
+int MappedWorld::get(int x, int y) {
+    if (x > 0 && x <= height && y > 0 && y <= width) {
+        return (current()[size_t(x - 1) * words + (y - 1) / 64] >> ((y - 1) % 64)) & 1;
+    }
+    return 100;
+}
+
+void MappedWorld::describe(long long generation, const Rule& rule, bool torus) {
+    head->generation = generation;
+    head->birth = rule.birth;
+    head->survive = rule.survive;
+    head->states = uint32_t(rule.states);
+    head->torus = torus;
+}
@@ -0,0 +1,173 @@
+#include <string>
+#include <vector>
+#include <fstream>
+#include <sstream>
+#include <algorithm>
+#include <thread>
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+#ifdef __linux__
+#include <sched.h>
+#include <pthread.h>
+#endif
+
+#include "include/Numa.h"
+
+namespace {
+    struct Topology {
+        std::vector<int> node;  // node of every CPU number
+        std::vector<int> cpus;  // allowed at start, by node and number
+        int nodes = 1;
+    };
+
+    // CPU numbers of a list like 0-3,8-11
+    std::vector<int> parse_cpulist(const std::string& text) {
+        std::vector<int> list;
+        std::istringstream stream(text);
+        std::string range;
+        while (std::getline(stream, range, ',')) {
+            if (range.empty() || range[0] < '0' || range[0] > '9') {
+                continue;
+            }
+            size_t dash = range.find('-');
+            int first = std::stoi(range.substr(0, dash));
+            int last = dash == std::string::npos ? first : std::stoi(range.substr(dash + 1));
+            for (int c = first; c <= last; c++) {
+                list.push_back(c);
+            }
+        }
+        return list;
+    }
+
+    Topology read_topology() {
+        Topology topo;
+        std::vector<int> allowed;
+#ifdef __linux__
+        cpu_set_t set;
+        CPU_ZERO(&set);
+        if (sched_getaffinity(0, sizeof(set), &set) == 0) {
+            for (int c = 0; c < CPU_SETSIZE; c++) {
+                if (CPU_ISSET(c, &set)) {
+                    allowed.push_back(c);
+                }
+            }
+        }
+        // node numbers may have gaps, a few missing ones in a row end the scan
+        for (int n = 0, missing = 0; missing < 8; n++) {
+            std::ifstream f("/sys/devices/system/node/node" + std::to_string(n) + "/cpulist");
+            std::string line;
+            if (!f.is_open() || !std::getline(f, line)) {
+                missing++;
+                continue;
+            }
+            missing = 0;
+            for (int c : parse_cpulist(line)) {
+                if (c >= int(topo.node.size())) {
+                    topo.node.resize(c + 1, 0);
+                }
+                topo.node[c] = n;
+            }
+            topo.nodes = std::max(topo.nodes, n + 1);
+        }
+#endif
+        if (allowed.empty()) {
+            for (int c = 0; c < int(std::max(1u, std::thread::hardware_concurrency())); c++) {
+                allowed.push_back(c);
+            }
+        }
+        std::stable_sort(allowed.begin(), allowed.end(), [&topo](int a, int b) {
+            int na = a < int(topo.node.size()) ? topo.node[a] : 0;
+            int nb = b < int(topo.node.size()) ? topo.node[b] : 0;
+            return na < nb;
+        });
+        topo.cpus = allowed;
+        return topo;
+    }
+
+    const Topology& topology() {
+        static const Topology topo = read_topology();
+        return topo;
+    }
+
+    bool is_pinned = false;
+
+#ifdef __linux__
+    // Restricts the calling thread to the CPUs in list
+    void bind(const std::vector<int>& list) {
+        cpu_set_t set;
+        CPU_ZERO(&set);
+        for (int c : list) {
+            CPU_SET(c, &set);
+        }
+        pthread_setaffinity_np(pthread_self(), sizeof(set), &set);
+    }
+#endif
+}
+
+namespace numa {
+    int nodes() {
+        return topology().nodes;
+    }
+
+    int node_of(int cpu) {
+        const std::vector<int>& node = topology().node;
+        return cpu >= 0 && cpu < int(node.size()) ? node[cpu] : 0;
+    }
+
+    const std::vector<int>& cpus() {
+        return topology().cpus;
+    }
+
+    bool pin_threads() {
+#if defined(_OPENMP) && defined(__linux__)
+        const std::vector<int>& list = cpus();
+        // threads a team starts later inherit the mask of the master, so every size is pinned anew
+        #pragma omp parallel
+        {
+            bind(std::vector<int>(1, list[omp_get_thread_num() % list.size()]));
+        }
+        is_pinned = true;
+        return true;
+#else
+        return false;
+#endif
+    }
+
+    void unpin_threads() {
+#if defined(_OPENMP) && defined(__linux__)
+        #pragma omp parallel
+        {
+            bind(cpus());
+        }
+#endif
+        is_pinned = false;
+    }
+
+    void unpin_this_thread() {
+#ifdef __linux__
+        bind(cpus());
+#endif
+    }
+
+    bool pinned() {
+        return is_pinned;
+    }
+
+    std::vector<int> team_nodes() {
+        std::vector<int> count(nodes(), 0);
+#if defined(_OPENMP) && defined(__linux__)
+        #pragma omp parallel
+        {
+            int node = std::min(node_of(sched_getcpu()), nodes() - 1);
+            #pragma omp atomic
+            count[node]++;
+        }
+#elif defined(__linux__)
+        count[std::min(node_of(sched_getcpu()), nodes() - 1)]++;
+#else
+        count[0]++;
+#endif
+        return count;
+    }
+}
@@ -0,0 +1,156 @@
+#include <cstdint>
+#include <vector>
+#include <random>
+#include <algorithm>
+
+#include "include/PackedWorld.h"
+#include "include/BitLife.h"
+#include "include/Hash.h"
+#include "include/Census.h"
+
+PackedWorld::PackedWorld(): height(0), width(0), words(0), stride(2), last_mask(0) {}
+
+PackedWorld::PackedWorld(int height, int width): height(height), width(width) {
+    words = (width + 63) / 64;
+    stride = words + 2;
+    int rest = width % 64;
+    last_mask = rest == 0 ? ~uint64_t(0) : (uint64_t(1) << rest) - 1;
+    state1.assign(size_t(height + 2) * stride, 0);
+    state2.assign(size_t(height + 2) * stride, 0);
+}
+
+int PackedWorld::get_height() {
+    return height;
+}
+
+int PackedWorld::get_width() {
+    return width;
+}
+
+uint64_t* PackedWorld::cell_word(std::vector<uint64_t>& state, int x, int y) {
+    return &state[size_t(x) * stride + 1 + (y - 1) / 64];
+}
+
+void PackedWorld::evolve() {
+    long long before = stats().population;
+    uint64_t h = 0;
+    census::Tally tally;
+    // one contiguous band of rows per thread
+    #pragma omp parallel for schedule(static) reduction(^:h) reduction(tally:tally)
+    for (int i = 1; i <= height; i++) {
+        const uint64_t* up = &state1[size_t(i - 1) * stride];
+        const uint64_t* mid = up + stride;
+        const uint64_t* dn = mid + stride;
+        uint64_t* out = &state2[size_t(i) * stride];
+        uint64_t acc = 0;
+        for (int k = 1; k < words; k++) {
+            out[k] = bitlife::step(up[k-1], up[k], up[k+1],
+                                   mid[k-1], mid[k], mid[k+1],
+                                   dn[k-1], dn[k], dn[k+1]);
+            acc = hashing::fold(acc, out[k]);
+        }
+        // cells right of the last column are part of the zero border
+        out[words] = last_mask & bitlife::step(up[words-1], up[words], up[words+1],
+                                               mid[words-1], mid[words], mid[words+1],
+                                               dn[words-1], dn[words], dn[words+1]);
+        acc = hashing::fold(acc, out[words]);
+        h ^= hashing::row(i, acc);
+        tally.words(i, 1, out + 1, mid + 1, words);
+    }
+    state_hash = h;
+    counted = tally.result(before);
+    counted_valid = true;
+    std::swap(state1, state2);
+}
+
+uint64_t PackedWorld::hash() {
+    return state_hash;
+}
+
+size_t PackedWorld::memory() {
+    return (state1.capacity() + state2.capacity()) * sizeof(uint64_t);
+}
+
+uint64_t PackedWorld::row_hash(const std::vector<uint64_t>& state, int i) {
+    uint64_t acc = 0;
+    for (int k = 1; k <= words; k++) {
+        acc = hashing::fold(acc, state[size_t(i) * stride + k]);
+    }
+    return hashing::row(i, acc);
+}
+
+void PackedWorld::rehash() {
+    state_hash = 0;
+    for (int i = 1; i <= height; i++) {
+        state_hash ^= row_hash(state1, i);
+    }
+}
+
+void PackedWorld::random(double probability) {
+    std::random_device rd;
+    std::mt19937 gen(rd());
+    std::bernoulli_distribution dist(probability);
+    for (int i = 1; i <= height; i++) {
+        uint64_t* row = &state1[size_t(i) * stride + 1];
+        std::fill(row, row + words, 0);
+        // the bits go straight into the words, the hash is rebuilt once at the end
+        for (int j = 1; j <= width; j++) {
+            if (dist(gen)) {
+                row[(j - 1) / 64] |= uint64_t(1) << ((j - 1) % 64);
+            }
+        }
+    }
+    rehash();
+    counted_valid = false;
+}
+
+void PackedWorld::pack(uint64_t* rows) {
+    for (int i = 1; i <= height; i++) {
+        const uint64_t* row = &state1[size_t(i) * stride + 1];
+        std::copy(row, row + words, rows + size_t(i - 1) * words);
+    }
+}
+
+void PackedWorld::unpack(const uint64_t* rows) {
+    for (int i = 1; i <= height; i++) {
+        uint64_t* row = &state1[size_t(i) * stride + 1];
+        std::copy(rows + size_t(i - 1) * words, rows + size_t(i) * words, row);
+        // bits right of the last column would be born into the border
+        row[words - 1] &= last_mask;
+    }
+    rehash();
+    counted_valid = false;
+}
+
+void PackedWorld::set(int x, int y) {
+    if (x > 0 && x <= height && y > 0 && y <= width) {
+        state_hash ^= row_hash(state1, x);
+        *cell_word(state1, x, y) |= uint64_t(1) << ((y - 1) % 64);
+        state_hash ^= row_hash(state1, x);
+        counted_valid = false;
+    }
+}
+
+void PackedWorld::set_run(int x, int y, int n) {
+    int first = std::max(y, 1);
+    int last = int(std::min<long long>((long long)y + n - 1, width));
+    if (x < 1 || x > height || first > last) {
+        return;
+    }
+    state_hash ^= row_hash(state1, x);
+    for (int k = (first - 1) / 64; k <= (last - 1) / 64; k++) {
+        int lo = std::max(first - 1 - 64 * k, 0);
+        int hi = std::min(last - 1 - 64 * k, 63);
+        uint64_t upto = hi == 63 ? ~uint64_t(0) : (uint64_t(1) << (hi + 1)) - 1;
+        state1[size_t(x) * stride + 1 + k] |= upto & ~((uint64_t(1) << lo) - 1);
+    }
+    state_hash ^= row_hash(state1, x);
+    counted_valid = false;
+}
+
+int PackedWorld::get(int x, int y) {
+    if (x > 0 && x <= height && y > 0 && y <= width) {
+        return (*cell_word(state1, x, y) >> ((y - 1) % 64)) & 1;
+    }
+    return 100;
+}
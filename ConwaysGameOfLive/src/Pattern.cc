@@ -0,0 +1,242 @@
+#include <cstdio>
+#include <cctype>
+#include <string>
+#include <vector>
+#include <limits>
+#include <istream>
+#include <ostream>
+#include <stdexcept>
+#include <algorithm>
+
+#include "include/Pattern.h"
+
+namespace {
+
+    // Reads a stream in 64 KiB blocks, one virtual call per block instead of per character
+    class Source {
+        private:
+
+            std::istream& in;
+            std::vector<char> buffer;
+            size_t at = 0;
+            size_t size = 0;
+
+        public:
+
+            explicit Source(std::istream& in): in(in), buffer(1 << 16) {}
+
+            int next() {
+                if (at == size) {
+                    in.read(buffer.data(), std::streamsize(buffer.size()));
+                    size = size_t(in.gcount());
+                    at = 0;
+                    if (size == 0) {
+                        return EOF;
+                    }
+                }
+                return (unsigned char)buffer[at++];
+            }
+
+            // The rest of the current line, without the newline
+            std::string line() {
+                std::string text;
+                int c;
+                while ((c = next()) != EOF && c != '\n') {
+                    text += char(c);
+                }
+                return text;
+            }
+    };
+
+    // Hands the run to the world if it starts inside the int range of its coordinates
+    void place(Engine& world, long long x, long long y, long long n) {
+        const long long top = std::numeric_limits<int>::max();
+        if (x >= 1 && x <= top && y <= top && y + n > 1) {
+            long long first = std::max(y, 1LL);
+            world.set_run(int(x), int(first), int(std::min(y + n - first, top)));
+        }
+    }
+
+    // Picks the rule out of "x = 3, y = 3, rule = B3/S23", the part after the x
+    void parse_header(const std::string& text, Rule& rule) {
+        size_t at = text.find("rule");
+        if (at == std::string::npos) {
+            return;
+        }
+        at = text.find('=', at);
+        if (at == std::string::npos) {
+            throw std::runtime_error("No rule after rule in the RLE header");
+        }
+        size_t end = text.find(',', at);
+        std::string value = text.substr(at + 1, end == std::string::npos ? std::string::npos : end - at - 1);
+        value.erase(std::remove_if(value.begin(), value.end(), ::isspace), value.end());
+        rule = Rule::parse(value);
+    }
+
+    // Collects the runs of one output line and breaks lines before 70 characters
+    class Lines {
+        private:
+
+            std::ostream& out;
+            size_t width = 0;
+
+        public:
+
+            explicit Lines(std::ostream& out): out(out) {}
+
+            void run(long long n, char tag) {
+                std::string token = n > 1 ? std::to_string(n) + tag : std::string(1, tag);
+                if (width + token.size() > 70) {
+                    out << '\n';
+                    width = 0;
+                }
+                out << token;
+                width += token.size();
+            }
+
+            void end() {
+                run(1, '!');
+                out << '\n';
+            }
+    };
+}
+
+namespace pattern {
+
+    long long read_rle(std::istream& in, Engine& world, int x, int y, Rule& rule) {
+        Source source(in);
+        rule = Rule();
+        long long row = 0;
+        long long col = 0;
+        long long count = 0;
+        long long cells = 0;
+        bool line_start = true;
+        int c;
+        while ((c = source.next()) != EOF) {
+            if (line_start && (c == '#' || c == 'x')) {
+                std::string text = source.line();
+                if (c == 'x') {
+                    parse_header(text, rule);
+                }
+                continue;
+            }
+            line_start = c == '\n';
+            if (c >= '0' && c <= '9') {
+                count = count * 10 + (c - '0');
+                if (count > std::numeric_limits<int>::max()) {
+                    throw std::runtime_error("Run count too large in RLE");
+                }
+                continue;
+            }
+            if (std::isspace(c)) {
+                continue;
+            }
+            long long n = count == 0 ? 1 : count;
+            count = 0;
+            if (c == 'b' || c == '.') {
+                col += n;
+            } else if (c == '$') {
+                row += n;
+                col = 0;
+            } else if (c == '!') {
+                break;
+            } else if (std::isalpha(c)) {
+                // o, or a state of a multi-state pattern: A to X, with p to y prefixed above 24
+                if (c >= 'p' && c <= 'y') {
+                    source.next();
+                }
+                place(world, x + row, y + col, n);
+                cells += n;
+                col += n;
+            } else {
+                throw std::runtime_error(std::string("Unexpected character '") + char(c) + "' in RLE");
+            }
+        }
+        return cells;
+    }
+
+    long long read_cells(std::istream& in, Engine& world, int x, int y) {
+        Source source(in);
+        long long row = 0;
+        long long col = 0;
+        long long run = 0; // living cells ending at col
+        long long cells = 0;
+        bool line_start = true;
+        int c;
+        while (true) {
+            c = source.next();
+            if (line_start && c == '!') {
+                source.line();
+                continue;
+            }
+            bool alive = c == 'O' || c == '*';
+            if (!alive && run > 0) {
+                place(world, x + row, y + col - run, run);
+                cells += run;
+                run = 0;
+            }
+            if (c == EOF) {
+                break;
+            }
+            line_start = c == '\n';
+            if (c == '\n') {
+                row++;
+                col = 0;
+            } else if (c != '\r') {
+                run += alive;
+                col++;
+            }
+        }
+        return cells;
+    }
+
+    void write_rle(std::ostream& out, Engine& world, const Rule& rule) {
+        Stats s = world.stats();
+        out << "x = " << s.box_width() << ", y = " << s.box_height() << ", rule = " << rule.str() << '\n';
+        Lines lines(out);
+        long long rows_ended = 0;
+        for (long long i = s.min_row; i <= s.max_row; i++) {
+            long long j = s.min_col;
+            while (j <= s.max_col) {
+                int state = world.get(int(i), int(j)) == 1;
+                long long k = j + 1;
+                while (k <= s.max_col && (world.get(int(i), int(k)) == 1) == state) {
+                    k++;
+                }
+                if (!state && k > s.max_col) {
+                    // dead cells at the end of a row are left out
+                    break;
+                }
+                if (rows_ended > 0) {
+                    lines.run(rows_ended, '$');
+                    rows_ended = 0;
+                }
+                lines.run(k - j, state ? 'o' : 'b');
+                j = k;
+            }
+            rows_ended += i < s.max_row;
+        }
+        lines.end();
+    }
+
+    void write_cells(std::ostream& out, Engine& world) {
+        Stats s = world.stats();
+        out << "!Name: " << s.box_height() << "x" << s.box_width() << " pattern\n";
+        std::string line;
+        for (long long i = s.min_row; i <= s.max_row; i++) {
+            line.clear();
+            for (long long j = s.min_col; j <= s.max_col; j++) {
+                line += world.get(int(i), int(j)) == 1 ? 'O' : '.';
+            }
+            line.erase(line.find_last_not_of('.') + 1);
+            out << line << '\n';
+        }
+    }
+
+    std::string format_of(const std::string& path) {
+        size_t dot = path.rfind('.');
+        std::string extension = dot == std::string::npos ? "" : path.substr(dot + 1);
+        std::transform(extension.begin(), extension.end(), extension.begin(), ::tolower);
+        return extension == "rle" || extension == "cells" ? extension : "";
+    }
+}
@@ -0,0 +1,89 @@
+#include <chrono>
+#include <thread>
+#include <algorithm>
+
+#include "include/RenderThread.h"
+#include "include/Numa.h"
+
+FrameRing::FrameRing(size_t capacity) : slots(capacity) {}
+
+bool FrameRing::publish(Engine& world, long long generation) {
+    size_t h = head.load(std::memory_order_relaxed);
+    if (h - tail.load(std::memory_order_acquire) == slots.size()) {
+        return false;
+    }
+    Frame& frame = slots[h % slots.size()];
+    frame.generation = generation;
+    frame.height = world.get_height();
+    frame.width = world.get_width();
+    frame.rows.resize(size_t(frame.height) * ((size_t(frame.width) + 63) / 64));
+    world.pack(frame.rows.data());
+    head.store(h + 1, std::memory_order_release);
+    return true;
+}
+
+const Frame* FrameRing::latest(size_t& skipped) {
+    size_t t = tail.load(std::memory_order_relaxed);
+    size_t h = head.load(std::memory_order_acquire);
+    if (t == h) {
+        skipped = 0;
+        return nullptr;
+    }
+    skipped = h - 1 - t;
+    // the slots before the newest go back to the producer while the newest is drawn
+    tail.store(h - 1, std::memory_order_release);
+    return &slots[(h - 1) % slots.size()];
+}
+
+void FrameRing::release() {
+    tail.store(tail.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+}
+
+RenderThread::RenderThread(Renderer& renderer, int interval_ms)
+    : renderer(renderer), interval(interval_ms), ring(4) {
+    drawer = std::thread(&RenderThread::draw_loop, this);
+}
+
+RenderThread::~RenderThread() {
+    if (drawer.joinable()) {
+        stop.store(true, std::memory_order_release);
+        drawer.join();
+    }
+}
+
+void RenderThread::publish(Engine& world, long long generation) {
+    if (!ring.publish(world, generation)) {
+        refused.fetch_add(1, std::memory_order_relaxed);
+    }
+}
+
+void RenderThread::draw_latest() {
+    size_t older;
+    const Frame* frame = ring.latest(older);
+    if (frame == nullptr) {
+        return;
+    }
+    renderer.draw(frame->rows.data(), frame->height, frame->width);
+    ring.release();
+    drawn++;
+    skipped += older;
+}
+
+void RenderThread::draw_loop() {
+    numa::unpin_this_thread();
+    auto next = std::chrono::steady_clock::now();
+    while (!stop.load(std::memory_order_acquire)) {
+        draw_latest();
+        auto now = std::chrono::steady_clock::now();
+        // a renderer that fell behind starts over from now instead of drawing faster to catch up
+        next = std::max(next + interval, now + std::chrono::milliseconds(interval.count() > 0 ? 0 : 1));
+        std::this_thread::sleep_until(next);
+    }
+}
+
+void RenderThread::finish(long long& drawn, long long& dropped) {
+    stop.store(true, std::memory_order_release);
+    drawer.join();
+    drawn = this->drawn;
+    dropped = skipped + refused.load(std::memory_order_relaxed);
+}
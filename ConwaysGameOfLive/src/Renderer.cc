@@ -0,0 +1,214 @@
+#include <cerrno>
+#include <limits>
+#include <iostream>
+#include <stdexcept>
+#include <algorithm>
+
+#include <unistd.h>
+#include <sys/ioctl.h>
+
+#include "include/Renderer.h"
+
+namespace {
+
+    const uint8_t dying = 2;    // codes 2 to 11: decaying states, faded over 10 colours
+    const uint8_t density = 12; // codes 13 to 16: up to a quarter, half, three quarters or all cells alive
+
+    // Escapes and glyph of every code, each 3 columns wide like the cells of the text print
+    std::vector<std::string> make_glyphs() {
+        // 256 colour palette from yellow over red to dark red
+        static const int fade[] = {226, 220, 214, 208, 202, 196, 160, 124, 88, 52};
+        std::vector<std::string> glyphs(density + 5);
+        glyphs[0] = "\033[1m\033[90m░░\033[0m ";
+        glyphs[1] = "\033[1m\033[32m▓▓\033[0m ";
+        for (int i = 0; i < 10; i++) {
+            glyphs[dying + i] = "\033[38;5;" + std::to_string(fade[i]) + "m▒▒\033[0m ";
+        }
+        glyphs[density] = glyphs[0];
+        glyphs[density + 1] = "\033[32m░░\033[0m ";
+        glyphs[density + 2] = "\033[32m▒▒\033[0m ";
+        glyphs[density + 3] = "\033[32m▓▓\033[0m ";
+        glyphs[density + 4] = "\033[1m\033[32m██\033[0m ";
+        return glyphs;
+    }
+
+    int ceil_div(long long a, long long b) {
+        return int((a + b - 1) / b);
+    }
+
+    // Living cells among the n bits from bit first on of a packed row
+    int count_bits(const uint64_t* row, long long first, long long n) {
+        int count = 0;
+        while (n > 0) {
+            int bit = int(first & 63);
+            int take = int(std::min<long long>(64 - bit, n));
+            uint64_t mask = take == 64 ? ~0ULL : ((1ULL << take) - 1) << bit;
+            count += __builtin_popcountll(row[first >> 6] & mask);
+            first += take;
+            n -= take;
+        }
+        return count;
+    }
+
+    void append_number(std::string& out, int n) {
+        char digits[12];
+        int i = 0;
+        do {
+            digits[i++] = char('0' + n % 10);
+            n /= 10;
+        } while (n > 0);
+        while (i > 0) {
+            out += digits[--i];
+        }
+    }
+}
+
+void Renderer::set_zoom(int k, int top, int left) {
+    if (k < 0 || top < 1 || left < 1) {
+        throw std::runtime_error("Zoom must not be negative and the viewport has to start inside the world");
+    }
+    zoom = k;
+    this->top = top;
+    this->left = left;
+    reset();
+}
+
+void Renderer::reset() {
+    shown.clear();
+}
+
+void Renderer::move(int row, int col) {
+    out += "\033[";
+    append_number(out, row + 1);
+    out += ';';
+    append_number(out, 3 * col + 1);
+    out += 'H';
+}
+
+bool Renderer::layout(int height, int width) {
+    int term_rows;
+    int term_cols;
+    terminal_size(term_rows, term_cols);
+    // two lines stay free below the frame for what is printed after it
+    int max_rows = term_rows > 2 ? term_rows - 2 : std::numeric_limits<int>::max();
+    int max_cols = term_cols >= 3 ? term_cols / 3 : std::numeric_limits<int>::max();
+    long long seen_rows = std::max(height - top + 1, 0);
+    long long seen_cols = std::max(width - left + 1, 0);
+    int k = zoom;
+    if (k == 0) {
+        k = std::max(1, std::max(ceil_div(seen_rows, max_rows), ceil_div(seen_cols, max_cols)));
+    }
+    int r = std::min(ceil_div(seen_rows, k), max_rows);
+    int c = std::min(ceil_div(seen_cols, k), max_cols);
+    bool full = shown.empty() || r != rows || c != cols || k != shown_zoom;
+    rows = r;
+    cols = c;
+    shown_zoom = k;
+    next.assign(size_t(rows) * cols, 0);
+    return full;
+}
+
+void Renderer::shade(const uint64_t* bits, int height, int width) {
+    int k = shown_zoom;
+    size_t words = (size_t(width) + 63) / 64;
+    std::vector<int> counts(cols);
+    for (int sr = 0; sr < rows; sr++) {
+        long long first_row = top + (long long)sr * k;
+        long long last_row = std::min<long long>(first_row + k - 1, height);
+        std::fill(counts.begin(), counts.end(), 0);
+        for (long long i = first_row; i <= last_row; i++) {
+            const uint64_t* row = bits + size_t(i - 1) * words;
+            for (int sc = 0; sc < cols; sc++) {
+                long long first_col = left + (long long)sc * k;
+                counts[sc] += count_bits(row, first_col - 1, std::min<long long>(k, width - first_col + 1));
+            }
+        }
+        for (int sc = 0; sc < cols; sc++) {
+            uint8_t& code = next[size_t(sr) * cols + sc];
+            if (k == 1) {
+                code = counts[sc] > 0;
+            } else if (counts[sc] > 0) {
+                long long first_col = left + (long long)sc * k;
+                long long area = (last_row - first_row + 1) * std::min<long long>(k, width - first_col + 1);
+                code = uint8_t(density + ceil_div(counts[sc] * 4LL, area));
+            }
+        }
+    }
+}
+
+void Renderer::draw(Engine& world, int states) {
+    int height = world.get_height();
+    int width = world.get_width();
+    bool full = layout(height, width);
+    if (states > 2 && shown_zoom == 1) {
+        // only the cells themselves know how far they decayed
+        for (int sr = 0; sr < rows; sr++) {
+            for (int sc = 0; sc < cols; sc++) {
+                int state = world.get(top + sr, left + sc);
+                next[size_t(sr) * cols + sc] = state == 1 ? 1 : state > 1 ? uint8_t(dying + (state - 2) * 10 / std::max(states - 2, 1)) : 0;
+            }
+        }
+    } else {
+        bits.resize(size_t(height) * ((size_t(width) + 63) / 64));
+        world.pack(bits.data());
+        shade(bits.data(), height, width);
+    }
+    emit(full);
+}
+
+void Renderer::draw(const uint64_t* rows, int height, int width) {
+    bool full = layout(height, width);
+    shade(rows, height, width);
+    emit(full);
+}
+
+void Renderer::emit(bool full) {
+    static const std::vector<std::string> glyphs = make_glyphs();
+    out.clear();
+    if (full) {
+        out += "\033[2J"; // Clear screen
+    }
+    for (int sr = 0; sr < rows; sr++) {
+        int after = -1; // screen cell the cursor is in after the last glyph written
+        for (int sc = 0; sc < cols; sc++) {
+            size_t at = size_t(sr) * cols + sc;
+            if (!full && shown[at] == next[at]) {
+                continue;
+            }
+            if (sc != after) {
+                move(sr, sc);
+            }
+            out += glyphs[next[at]];
+            after = sc + 1;
+        }
+    }
+    move(rows + 1, 0);
+    shown.swap(next);
+
+    // whatever went to std::cout before belongs above the frame
+    std::cout.flush();
+    const char* p = out.data();
+    size_t remaining = out.size();
+    while (remaining > 0) {
+        ssize_t n = ::write(STDOUT_FILENO, p, remaining);
+        if (n < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            break;
+        }
+        p += n;
+        remaining -= size_t(n);
+    }
+}
+
+void Renderer::terminal_size(int& rows, int& cols) {
+    struct winsize ws;
+    if (isatty(STDOUT_FILENO) && ioctl(STDOUT_FILENO, TIOCGWINSZ, &ws) == 0 && ws.ws_row > 0 && ws.ws_col > 0) {
+        rows = ws.ws_row;
+        cols = ws.ws_col;
+    } else {
+        rows = 0;
+        cols = 0;
+    }
+}
@@ -0,0 +1,107 @@
+#include <string>
+#include <vector>
+#include <cctype>
+#include <stdexcept>
+
+#include "include/Rule.h"
+
+// Mask of the neighbour counts in digits, e.g. "23" gives bits 2 and 3
+static uint32_t count_mask(const std::string& digits, const std::string& text) {
+    uint32_t mask = 0;
+    for (char c : digits) {
+        if (c < '0' || c > '8') {
+            throw std::runtime_error("Neighbour counts must be digits 0 to 8: " + text);
+        }
+        mask |= 1u << (c - '0');
+    }
+    return mask;
+}
+
+Rule Rule::parse(const std::string& text) {
+    std::string s;
+    for (char c : text) {
+        s += std::tolower(static_cast<unsigned char>(c));
+    }
+    if (s == "life") {
+        return Rule();
+    }
+    if (s == "highlife") {
+        return parse("B36/S23");
+    }
+    if (s == "daynight") {
+        return parse("B3678/S34678");
+    }
+    if (s == "seeds") {
+        return parse("B2/S");
+    }
+    if (s == "brianbrain") {
+        return parse("B2/S/C3");
+    }
+    if (s == "starwars") {
+        return parse("B2/S345/C4");
+    }
+    std::vector<std::string> parts;
+    size_t start = 0;
+    for (size_t slash = s.find('/'); slash != std::string::npos; slash = s.find('/', start)) {
+        parts.push_back(s.substr(start, slash - start));
+        start = slash + 1;
+    }
+    parts.push_back(s.substr(start));
+    if (parts.size() < 2 || parts.size() > 3) {
+        throw std::runtime_error("Rule must look like B3/S23 or B2/S/C3: " + text);
+    }
+    Rule rule(0, 0);
+    bool seen[3] = {false, false, false}; // birth, survive, states
+    bool letters = !parts[0].empty() && std::isalpha(static_cast<unsigned char>(parts[0][0]));
+    if (!letters && parts.size() == 3) {
+        // Generations S/B/C as digits only
+        parts[0] = "s" + parts[0];
+        parts[1] = "b" + parts[1];
+        parts[2] = "c" + parts[2];
+    }
+    for (const std::string& part : parts) {
+        int kind = part.empty() ? -1 : part[0] == 'b' ? 0 : part[0] == 's' ? 1 : part[0] == 'c' || part[0] == 'g' ? 2 : -1;
+        if (kind < 0 || seen[kind]) {
+            throw std::runtime_error("Rule must look like B3/S23 or B2/S/C3: " + text);
+        }
+        seen[kind] = true;
+        std::string digits = part.substr(1);
+        if (kind == 0) {
+            rule.birth = count_mask(digits, text);
+        } else if (kind == 1) {
+            rule.survive = count_mask(digits, text);
+        } else {
+            if (digits.empty() || digits.size() > 3 || digits.find_first_not_of("0123456789") != std::string::npos
+                || std::stoi(digits) < 2 || std::stoi(digits) > 255) {
+                throw std::runtime_error("Number of states must be between 2 and 255: " + text);
+            }
+            rule.states = std::stoi(digits);
+        }
+    }
+    if (!seen[0] || !seen[1]) {
+        throw std::runtime_error("Rule must look like B3/S23 or B2/S/C3: " + text);
+    }
+    if (rule.birth & 1) {
+        throw std::runtime_error("B0 rules are not supported, the border outside the world would be born");
+    }
+    return rule;
+}
+
+std::string Rule::str() const {
+    std::string s = "B";
+    for (int n = 0; n < 9; n++) {
+        if ((birth >> n) & 1) {
+            s += char('0' + n);
+        }
+    }
+    s += "/S";
+    for (int n = 0; n < 9; n++) {
+        if ((survive >> n) & 1) {
+            s += char('0' + n);
+        }
+    }
+    if (states > 2) {
+        s += "/C" + std::to_string(states);
+    }
+    return s;
+}
@@ -0,0 +1,178 @@
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <vector>
+#include <fstream>
+#include <stdexcept>
+#include <algorithm>
+
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include "include/Snapshot.h"
+
+const uint32_t SnapshotHeader::current;
+const uint32_t SnapshotHeader::rle;
+const uint32_t SnapshotHeader::swapped;
+
+void Snapshot::capture(Engine& world, long long generation, const Rule& rule, bool torus) {
+    // one bit per cell cannot tell the decaying states of a Generations rule apart from dead cells
+    if (rule.states > 2) {
+        throw std::runtime_error("Snapshots hold living cells only, " + rule.str() + " has "
+                                 + std::to_string(rule.states) + " states. Use the text format");
+    }
+    height = world.get_height();
+    width = world.get_width();
+    this->generation = generation;
+    this->rule = rule;
+    this->torus = torus;
+    rows.resize(size_t(height) * words());
+    world.pack(rows.data());
+}
+
+void Snapshot::write(const std::string& path, bool compress) const {
+    std::vector<uint64_t> encoded;
+    if (compress) {
+        rle::encode(rows, encoded);
+    }
+    const std::vector<uint64_t>& payload = compress ? encoded : rows;
+    SnapshotHeader header;
+    std::memset(&header, 0, sizeof(header));
+    std::memcpy(header.magic, snapshot_magic, sizeof(header.magic));
+    header.version = SnapshotHeader::current;
+    header.flags = compress ? SnapshotHeader::rle : 0;
+    header.height = height;
+    header.width = width;
+    header.generation = generation;
+    header.birth = rule.birth;
+    header.survive = rule.survive;
+    header.states = uint32_t(rule.states);
+    header.torus = torus;
+    header.payload = payload.size() * sizeof(uint64_t);
+    std::string tmp = path + ".tmp";
+    {
+        std::ofstream f(tmp, std::ios::binary | std::ios::trunc);
+        f.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        f.write(reinterpret_cast<const char*>(payload.data()), std::streamsize(header.payload));
+        if (!f.flush()) {
+            throw std::runtime_error("Cannot write " + tmp);
+        }
+    }
+    if (std::rename(tmp.c_str(), path.c_str()) != 0) {
+        throw std::runtime_error("Cannot replace " + path);
+    }
+}
+
+bool Snapshot::is_snapshot(const std::string& path) {
+    std::ifstream f(path, std::ios::binary);
+    char magic[sizeof(snapshot_magic)];
+    return f.read(magic, sizeof(magic)) && std::memcmp(magic, snapshot_magic, sizeof(magic)) == 0;
+}
+
+SnapshotFile::SnapshotFile(const std::string& path) {
+    fd = open(path.c_str(), O_RDONLY);
+    struct stat st;
+    if (fd < 0 || fstat(fd, &st) != 0) {
+        if (fd >= 0) {
+            close(fd);
+        }
+        throw std::runtime_error("Cannot open " + path);
+    }
+    size = size_t(st.st_size);
+    if (size >= sizeof(SnapshotHeader)) {
+        map = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    }
+    if (map == nullptr || map == MAP_FAILED) {
+        map = nullptr;
+        close(fd);
+        throw std::runtime_error(path + " is not a snapshot");
+    }
+    // the rows are read once from front to back
+    madvise(map, size, MADV_SEQUENTIAL);
+    head = static_cast<const SnapshotHeader*>(map);
+    std::string problem;
+    if (std::memcmp(head->magic, snapshot_magic, sizeof(head->magic)) != 0) {
+        problem = path + " is not a snapshot";
+    } else if (head->version != SnapshotHeader::current || head->height <= 0 || head->width <= 0
+               || head->payload % sizeof(uint64_t) != 0) {
+        problem = "Unsupported snapshot " + path;
+    } else if ((head->flags & SnapshotHeader::rle) && (head->flags & SnapshotHeader::swapped)) {
+        problem = "Unsupported snapshot " + path;
+    } else if (head->payload * ((head->flags & SnapshotHeader::swapped) ? 2 : 1) > size - sizeof(SnapshotHeader)) {
+        problem = "Snapshot " + path + " is cut short";
+    } else if (!(head->flags & SnapshotHeader::rle)
+               && head->payload != uint64_t(head->height) * ((head->width + 63) / 64) * sizeof(uint64_t)) {
+        problem = "Snapshot " + path + " has the wrong size";
+    }
+    if (!problem.empty()) {
+        munmap(map, size);
+        close(fd);
+        throw std::runtime_error(problem);
+    }
+}
+
+SnapshotFile::~SnapshotFile() {
+    munmap(map, size);
+    close(fd);
+}
+
+void SnapshotFile::restore(Engine& world) const {
+    // the header is 64 bytes, so the payload words are aligned in the page aligned mapping
+    const uint64_t* payload = reinterpret_cast<const uint64_t*>(head + 1);
+    if (head->flags & SnapshotHeader::swapped) {
+        payload += head->payload / sizeof(uint64_t);
+    }
+    if (!(head->flags & SnapshotHeader::rle)) {
+        world.unpack(payload);
+        return;
+    }
+    std::vector<uint64_t> rows(size_t(head->height) * ((head->width + 63) / 64));
+    rle::decode(payload, head->payload / sizeof(uint64_t), rows.data(), rows.size());
+    world.unpack(rows.data());
+}
+
+namespace rle {
+
+    void encode(const std::vector<uint64_t>& words, std::vector<uint64_t>& out) {
+        out.clear();
+        size_t i = 0;
+        while (i < words.size()) {
+            size_t zeros = i;
+            while (zeros < words.size() && words[zeros] == 0) {
+                zeros++;
+            }
+            size_t literals = zeros;
+            while (literals < words.size() && words[literals] != 0) {
+                literals++;
+            }
+            out.push_back(zeros - i);
+            out.push_back(literals - zeros);
+            out.insert(out.end(), words.begin() + zeros, words.begin() + literals);
+            i = literals;
+        }
+    }
+
+    void decode(const uint64_t* in, size_t size, uint64_t* out, size_t n) {
+        size_t at = 0;
+        size_t i = 0;
+        while (i + 2 <= size) {
+            uint64_t zeros = in[i];
+            uint64_t literals = in[i + 1];
+            i += 2;
+            if (zeros > n - at || literals > n - at - zeros || literals > size - i) {
+                throw std::runtime_error("Broken run-length encoding");
+            }
+            std::fill(out + at, out + at + zeros, 0);
+            at += zeros;
+            std::copy(in + i, in + i + literals, out + at);
+            at += literals;
+            i += literals;
+        }
+        if (at != n || i != size) {
+            throw std::runtime_error("Broken run-length encoding");
+        }
+    }
+}
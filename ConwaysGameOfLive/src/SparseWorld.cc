@@ -0,0 +1,247 @@
+#include <cstdint>
+#include <vector>
+#include <random>
+#include <algorithm>
+#include <unordered_map>
+
+#include "include/SparseWorld.h"
+#include "include/BitLife.h"
+#include "include/Hash.h"
+#include "include/Census.h"
+
+SparseWorld::SparseWorld(): height(0), width(0) {}
+
+SparseWorld::SparseWorld(int height, int width): height(height), width(width) {}
+
+int SparseWorld::get_height() {
+    return height;
+}
+
+int SparseWorld::get_width() {
+    return width;
+}
+
+// Floor division by the chunk size, also for negative coordinates
+static int64_t chunk_of(int64_t v) {
+    return v >= 0 ? v / 64 : -((-v + 63) / 64);
+}
+
+uint64_t SparseWorld::key(int64_t cy, int64_t cx) {
+    return (uint64_t(uint32_t(cy)) << 32) | uint32_t(cx);
+}
+
+SparseWorld::Chunk* SparseWorld::chunk(int64_t cy, int64_t cx, bool create) {
+    auto it = chunks.find(key(cy, cx));
+    if (it != chunks.end()) {
+        return &it->second;
+    }
+    if (!create) {
+        return nullptr;
+    }
+    Chunk& c = chunks[key(cy, cx)];
+    std::fill(&c.rows[0][0], &c.rows[0][0] + 2 * size, 0);
+    return &c;
+}
+
+void SparseWorld::evolve() {
+    long long before = stats().population;
+    // cells on a chunk edge can give birth in the neighbouring chunk, make sure it exists
+    std::vector<std::pair<int64_t, int64_t> > grow;
+    for (auto& kv : chunks) {
+        const uint64_t* r = kv.second.rows[parity];
+        int64_t cy = int32_t(kv.first >> 32);
+        int64_t cx = int32_t(kv.first & 0xffffffff);
+        uint64_t any = 0;
+        for (int i = 0; i < size; i++) {
+            any |= r[i];
+        }
+        bool north = r[0] != 0;
+        bool south = r[size - 1] != 0;
+        bool west = (any & 1) != 0;
+        bool east = (any >> 63) != 0;
+        if (north) grow.push_back(std::make_pair(cy - 1, cx));
+        if (south) grow.push_back(std::make_pair(cy + 1, cx));
+        if (west) grow.push_back(std::make_pair(cy, cx - 1));
+        if (east) grow.push_back(std::make_pair(cy, cx + 1));
+        if (r[0] & 1) grow.push_back(std::make_pair(cy - 1, cx - 1));
+        if (r[0] >> 63) grow.push_back(std::make_pair(cy - 1, cx + 1));
+        if (r[size - 1] & 1) grow.push_back(std::make_pair(cy + 1, cx - 1));
+        if (r[size - 1] >> 63) grow.push_back(std::make_pair(cy + 1, cx + 1));
+    }
+    for (auto& p : grow) {
+        chunk(p.first, p.second, true);
+    }
+
+    // neighbours are looked up once per chunk and generation, missing ones read as zero
+    static const uint64_t zero[size] = {0};
+    struct Work {
+        Chunk* c;
+        const uint64_t* n[9]; // 3x3 block of current rows around c, n[4] is c itself
+        int64_t row;          // plane cell of the upper left corner of c
+        int64_t col;
+    };
+    std::vector<Work> work;
+    work.reserve(chunks.size());
+    for (auto& kv : chunks) {
+        int64_t cy = int32_t(kv.first >> 32);
+        int64_t cx = int32_t(kv.first & 0xffffffff);
+        Work w;
+        w.c = &kv.second;
+        w.row = cy * size;
+        w.col = cx * size;
+        for (int dy = -1; dy <= 1; dy++) {
+            for (int dx = -1; dx <= 1; dx++) {
+                Chunk* nb = chunk(cy + dy, cx + dx, false);
+                w.n[(dy + 1) * 3 + dx + 1] = nb ? nb->rows[parity] : zero;
+            }
+        }
+        work.push_back(w);
+    }
+
+    int next = parity ^ 1;
+    int n_work = work.size();
+    census::Tally tally;
+    #pragma omp parallel for schedule(static) reduction(tally:tally)
+    for (int k = 0; k < n_work; k++) {
+        const Work& w = work[k];
+        uint64_t* out = w.c->rows[next];
+        for (int i = 0; i < size; i++) {
+            // the row above and below may come from the chunks to the north and south
+            int up = i == 0 ? 0 : 3;
+            int dn = i == size - 1 ? 6 : 3;
+            int iu = i == 0 ? size - 1 : i - 1;
+            int id = i == size - 1 ? 0 : i + 1;
+            out[i] = bitlife::step(w.n[up][iu], w.n[up + 1][iu], w.n[up + 2][iu],
+                                   w.n[3][i], w.n[4][i], w.n[5][i],
+                                   w.n[dn][id], w.n[dn + 1][id], w.n[dn + 2][id]);
+        }
+        tally.rows(w.row, w.col, out, w.n[4], size);
+    }
+    parity = next;
+    counted = tally.result(before);
+    counted_valid = true;
+
+    // free chunks that went empty and hash the others
+    state_hash = 0;
+    for (auto it = chunks.begin(); it != chunks.end();) {
+        const uint64_t* r = it->second.rows[parity];
+        uint64_t any = 0;
+        for (int i = 0; i < size; i++) {
+            any |= r[i];
+        }
+        if (any == 0) {
+            it = chunks.erase(it);
+        } else {
+            state_hash ^= chunk_hash(it->first, r);
+            ++it;
+        }
+    }
+}
+
+uint64_t SparseWorld::chunk_hash(uint64_t key, const uint64_t* rows) {
+    uint64_t h = 0;
+    for (int i = 0; i < size; i++) {
+        if (rows[i]) {
+            h ^= hashing::word(key * size + i, rows[i]);
+        }
+    }
+    return h;
+}
+
+Stats SparseWorld::stats() {
+    if (!counted_valid) {
+        census::Tally tally;
+        for (auto& kv : chunks) {
+            int64_t cy = int32_t(kv.first >> 32);
+            int64_t cx = int32_t(kv.first & 0xffffffff);
+            const uint64_t* r = kv.second.rows[parity];
+            tally.rows(cy * size, cx * size, r, r, size);
+        }
+        counted = tally.result(-1);
+        counted_valid = true;
+    }
+    // counted is in plane cells, the window shows plane cell (origin_row, origin_col) at (1, 1)
+    Stats s = counted;
+    if (s.population > 0) {
+        s.min_row += 1 - origin_row;
+        s.max_row += 1 - origin_row;
+        s.min_col += 1 - origin_col;
+        s.max_col += 1 - origin_col;
+    }
+    return s;
+}
+
+size_t SparseWorld::memory() {
+    // every map node holds the key, the chunk and the bucket chain pointer
+    return chunks.size() * (sizeof(uint64_t) + sizeof(Chunk) + sizeof(void*)) + chunks.bucket_count() * sizeof(void*);
+}
+
+uint64_t SparseWorld::hash() {
+    return state_hash;
+}
+
+void SparseWorld::random(double probability) {
+    std::random_device rd;
+    std::mt19937 gen(rd());
+    std::bernoulli_distribution dist(probability);
+    // the whole plane is cleared first, like the dense engines overwrite every cell
+    chunks.clear();
+    state_hash = 0;
+    counted_valid = false;
+    for (int i = 1; i <= height; i++) {
+        for (int j = 1; j <= width; j++) {
+            if (dist(gen)) {
+                set(i, j);
+            }
+        }
+    }
+}
+
+void SparseWorld::set_cell(int64_t row, int64_t col) {
+    int64_t cy = chunk_of(row);
+    int64_t cx = chunk_of(col);
+    uint64_t* r = chunk(cy, cx, true)->rows[parity];
+    state_hash ^= chunk_hash(key(cy, cx), r);
+    r[row - cy * size] |= uint64_t(1) << (col - cx * size);
+    state_hash ^= chunk_hash(key(cy, cx), r);
+    counted_valid = false;
+}
+
+int SparseWorld::get_cell(int64_t row, int64_t col) {
+    int64_t cy = chunk_of(row);
+    int64_t cx = chunk_of(col);
+    Chunk* c = chunk(cy, cx, false);
+    return c ? (c->rows[parity][row - cy * size] >> (col - cx * size)) & 1 : 0;
+}
+
+void SparseWorld::set(int x, int y) {
+    if (x > 0 && x <= height && y > 0 && y <= width) {
+        set_cell(origin_row + x - 1, origin_col + y - 1);
+    }
+}
+
+int SparseWorld::get(int x, int y) {
+    if (x > 0 && x <= height && y > 0 && y <= width) {
+        return get_cell(origin_row + x - 1, origin_col + y - 1);
+    }
+    return 100;
+}
+
+void SparseWorld::view(int64_t row, int64_t col) {
+    origin_row = row;
+    origin_col = col;
+}
+
+size_t SparseWorld::chunk_count() {
+    return chunks.size();
+}
+
+uint64_t SparseWorld::population() {
+    uint64_t pop = 0;
+    for (auto& kv : chunks) {
+        for (int i = 0; i < size; i++) {
+            pop += __builtin_popcountll(kv.second.rows[parity][i]);
+        }
+    }
+    return pop;
+}
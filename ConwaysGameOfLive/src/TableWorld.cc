@@ -0,0 +1,124 @@
+#include <cstdint>
+#include <vector>
+#include <stdexcept>
+
+#include "include/TableWorld.h"
+#include "include/Hash.h"
+#include "include/Census.h"
+
+namespace tablelife {
+    std::vector<uint8_t> build(const Rule& rule) {
+        std::vector<uint8_t> t(1 << 16);
+        for (int idx = 0; idx < (1 << 16); idx++) {
+            uint8_t next = 0;
+            for (int r = 1; r <= 2; r++) {
+                for (int c = 1; c <= 2; c++) {
+                    int n_sum = 0;
+                    for (int dr = -1; dr <= 1; dr++) {
+                        for (int dc = -1; dc <= 1; dc++) {
+                            if (dr != 0 || dc != 0) {
+                                n_sum += (idx >> ((r + dr) * 4 + c + dc)) & 1;
+                            }
+                        }
+                    }
+                    int alive = (idx >> (r * 4 + c)) & 1;
+                    if ((((alive ? rule.survive : rule.birth) >> n_sum) & 1) != 0) {
+                        next |= 1 << ((r - 1) * 2 + c - 1);
+                    }
+                }
+            }
+            t[idx] = next;
+        }
+        return t;
+    }
+}
+
+TableWorld::TableWorld(): PackedWorld(), table(tablelife::build(Rule())) {}
+
+TableWorld::TableWorld(int height, int width): PackedWorld(height, width), table(tablelife::build(Rule())) {}
+
+void TableWorld::set_rule(const Rule& rule) {
+    if (rule.states != 2) {
+        throw std::runtime_error("The table engine only runs two state rules, use the generations engine");
+    }
+    table = tablelife::build(rule);
+}
+
+size_t TableWorld::memory() {
+    return PackedWorld::memory() + table.capacity();
+}
+
+void TableWorld::evolve() {
+    long long before = stats().population;
+    const uint8_t* t = table.data();
+    // stands in for the row below the border when the height is odd
+    std::vector<uint64_t> zero(stride, 0);
+    int pairs = (height + 1) / 2;
+    uint64_t h = 0;
+    census::Tally tally;
+    // one contiguous band of row pairs per thread
+    #pragma omp parallel for schedule(static) reduction(^:h) reduction(tally:tally)
+    for (int p = 0; p < pairs; p++) {
+        int i = 2 * p + 1; // upper row of the pair
+        bool lower = i + 1 <= height;
+        const uint64_t* r0 = &state1[size_t(i - 1) * stride];
+        const uint64_t* r1 = r0 + stride;
+        const uint64_t* r2 = r1 + stride;
+        const uint64_t* r3 = lower ? r2 + stride : zero.data();
+        uint64_t* out0 = &state2[size_t(i) * stride];
+        uint64_t* out1 = out0 + stride;
+        uint64_t acc0 = 0;
+        uint64_t acc1 = 0;
+        for (int k = 1; k <= words; k++) {
+            // bit b of s* is column b-1 of the word, so bits 2m..2m+3 are the 4 columns around block m
+            uint64_t s0 = (r0[k] << 1) | (r0[k-1] >> 63);
+            uint64_t s1 = (r1[k] << 1) | (r1[k-1] >> 63);
+            uint64_t s2 = (r2[k] << 1) | (r2[k-1] >> 63);
+            uint64_t s3 = (r3[k] << 1) | (r3[k-1] >> 63);
+            uint64_t top = 0;
+            uint64_t bottom = 0;
+            // low nibble of every byte, so one byte of u01 and u23 each forms the index
+            const uint64_t nibbles = 0x0F0F0F0F0F0F0F0FULL;
+            for (int shift = 0; shift < 8; shift += 2) {
+                uint64_t u01 = ((s0 >> shift) & nibbles) | ((s1 >> shift) & nibbles) << 4;
+                uint64_t u23 = ((s2 >> shift) & nibbles) | ((s3 >> shift) & nibbles) << 4;
+                int blocks = shift == 6 ? 7 : 8;
+                for (int j = 0; j < blocks; j++) {
+                    int b = 8 * j + shift;
+                    uint64_t next = t[((u01 >> 8 * j) & 255) | ((u23 >> 8 * j) & 255) << 8];
+                    top |= (next & 3) << b;
+                    bottom |= (next >> 2) << b;
+                }
+            }
+            // the last block reaches into bit 0 of the next word
+            unsigned idx = (r0[k] >> 61 | (r0[k+1] & 1) << 3)
+                         | (r1[k] >> 61 | (r1[k+1] & 1) << 3) << 4
+                         | (r2[k] >> 61 | (r2[k+1] & 1) << 3) << 8
+                         | (r3[k] >> 61 | (r3[k+1] & 1) << 3) << 12;
+            uint64_t next = t[idx];
+            top |= (next & 3) << 62;
+            bottom |= (next >> 2) << 62;
+            if (k == words) {
+                // cells right of the last column are part of the zero border
+                top &= last_mask;
+                bottom &= last_mask;
+            }
+            out0[k] = top;
+            acc0 = hashing::fold(acc0, top);
+            if (lower) {
+                out1[k] = bottom;
+                acc1 = hashing::fold(acc1, bottom);
+            }
+        }
+        h ^= hashing::row(i, acc0);
+        tally.words(i, 1, out0 + 1, r1 + 1, words);
+        if (lower) {
+            h ^= hashing::row(i + 1, acc1);
+            tally.words(i + 1, 1, out1 + 1, r2 + 1, words);
+        }
+    }
+    state_hash = h;
+    counted = tally.result(before);
+    counted_valid = true;
+    std::swap(state1, state2);
+}
@@ -0,0 +1,60 @@
+#include "include/TileScheduler.h"
+
+void TileScheduler::fill(const std::vector<int>& tiles, const std::vector<int>& first, int n) {
+    this->tiles = tiles;
+    if (n > capacity) {
+        deques.reset(new Deque[n]);
+        capacity = n;
+    }
+    threads = n;
+    for (int k = 0; k < n; k++) {
+        deques[k].range.store(uint64_t(uint32_t(first[k])) << 32 | uint32_t(first[k + 1]), std::memory_order_relaxed);
+    }
+}
+
+int TileScheduler::pop(int k) {
+    uint64_t range = deques[k].range.load(std::memory_order_relaxed);
+    for (;;) {
+        uint32_t head = uint32_t(range >> 32);
+        uint32_t tail = uint32_t(range);
+        if (head >= tail) {
+            return -1;
+        }
+        // a failed exchange reloads range and tries again
+        if (deques[k].range.compare_exchange_weak(range, uint64_t(head + 1) << 32 | tail, std::memory_order_acq_rel)) {
+            return tiles[head];
+        }
+    }
+}
+
+int TileScheduler::steal(int k) {
+    uint64_t range = deques[k].range.load(std::memory_order_relaxed);
+    for (;;) {
+        uint32_t head = uint32_t(range >> 32);
+        uint32_t tail = uint32_t(range);
+        if (head >= tail) {
+            return -1;
+        }
+        if (deques[k].range.compare_exchange_weak(range, uint64_t(head) << 32 | (tail - 1), std::memory_order_acq_rel)) {
+            return tiles[tail - 1];
+        }
+    }
+}
+
+int TileScheduler::next(int k, long long& stolen) {
+    int t = k < threads ? pop(k) : -1;
+    if (t >= 0) {
+        return t;
+    }
+    // threads are pinned node by node, so the victims go outwards: k + 1, k - 1, k + 2, k - 2, ...
+    // a thread without a deque of its own starts at k itself
+    for (int d = k < threads ? 1 : 0; d < threads; d++) {
+        int victim = d % 2 ? k + (d + 1) / 2 : k - d / 2;
+        t = steal(((victim % threads) + threads) % threads);
+        if (t >= 0) {
+            stolen++;
+            return t;
+        }
+    }
+    return -1;
+}
@@ -6,15 +6,74 @@
 #include <chrono>
 #include <thread>
 #include <random>
+#include <algorithm>
+#include <stdexcept>
+#ifdef _OPENMP
+#include <omp.h>
+#endif
 
 #include "include/World.h"
+#include "include/Hash.h"
+
+const int World::tile_h;
+const int World::tile_w;
+const int World::block_h;
+const int World::max_block_depth;
+
+// One generation of the columns [c0, c1) of a row under rule r
+template <class R>
+static inline void life_row(const int* up, const int* mid, const int* dn, int* __restrict out, int c0, int c1, const R& r){
+    for (int j=c0; j<c1; j++){
+        int n_sum = up[j-1] + up[j] + up[j+1] + mid[j-1] + mid[j+1] + dn[j-1] + dn[j] + dn[j+1]; 
+        out[j] = r.next(n_sum, mid[j]); 
+    }
+}
+
+// Adds row i to the bounding box of s, cells points at column c0 of a row with a living
+// cell among the columns [c0, c1). Scanned from both ends while the row is still in cache
+static inline void add_span(Stats& s, int i, const int* cells, int c0, int c1){
+    int first = 0; 
+    while (cells[first] == 0){
+        first++; 
+    }
+    int last = c1 - c0 - 1; 
+    while (cells[last] == 0){
+        last--; 
+    }
+    if (s.max_row < s.min_row){
+        s.min_row = i; 
+        s.min_col = c0 + first; 
+        s.max_col = c0 + last; 
+    }
+    s.max_row = i; 
+    s.min_col = std::min<long long>(s.min_col, c0 + first); 
+    s.max_col = std::max<long long>(s.max_col, c0 + last); 
+}
+
+// Torus coordinate of i in 1..n
+static inline int wrap(int i, int n){
+    return ((i - 1) % n + n) % n + 1; 
+}
+
+// Copies the columns [c0, c1) of a torus row of width cells to out, in runs between the edges
+static inline void wrap_copy(const std::vector<int>& row, int c0, int c1, int width, int* out){
+    while (c0 < c1){
+        int j = wrap(c0, width); 
+        int n = std::min(c1 - c0, width + 1 - j); 
+        std::copy(row.begin() + j, row.begin() + j + n, out); 
+        out += n; 
+        c0 += n; 
+    }
+}
 
         World::World(): height(0), width(0){}
         
         World::World(int height, int width): height(height), width(width) {
-                    state1.resize(height+2, std::vector<int>(width+2, 0)); // Initialize with zeros
-                    state2.resize(height+2, std::vector<int>(width+2, 0)); 
-                    
+                    // the rows are allocated and zeroed by the threads that evolve them
+                    state1.resize(height+2); 
+                    state2.resize(height+2); 
+                    init_tiles(); 
+                    place_rows(); 
                 }
 
        
@@ -67,6 +126,9 @@
                     }
                     std::cout << std::endl;
                 }
+                init_tiles(); 
+                place_rows(); 
+                rehash(); 
             } else {
                 std::cout << "error opening file" << std::endl; 
             }
@@ -81,46 +143,419 @@
             return width; 
         }
 
-        int World::world_size(){
-            return width*height; 
+        void World::init_tiles(){
+            tile_rows = (height + tile_h - 1) / tile_h; 
+            tile_cols = (width + tile_w - 1) / tile_w; 
+            active.assign(tile_rows * tile_cols, 1); 
+            changed.assign(tile_rows * tile_cols, 0); 
+            col_weight.resize(width + 2); 
+            for (int j = 0; j < width + 2; j++){
+                col_weight[j] = uint32_t(hashing::mix64(j + 1)); 
+            }
         }
 
-        void World::evolve(){
-            int n_height = height+2; 
-            int n_width = width+2; 
-            for (int i=1; i<n_height-1; i++){
-                for (int j=1; j<n_width-1; j++){
+        int World::band_begin(int k, int n){
+            return int((long long)tile_rows * k / n); 
+        }
+
+        void World::place_rows(){
+            #pragma omp parallel
+            {
+                int k = 0; 
+                int n = 1; 
+#ifdef _OPENMP
+                k = omp_get_thread_num(); 
+                n = omp_get_num_threads(); 
+#endif
+                for (int b=band_begin(k, n); b<band_begin(k + 1, n); b++){
+                    // the borders go with the first and last band
+                    int first = b == 0 ? 0 : b * tile_h + 1; 
+                    int last = b == tile_rows - 1 ? height + 1 : (b + 1) * tile_h; 
+                    for (int i=first; i<=last; i++){
+                        // the copy is allocated and written here, the old row is freed
+                        std::vector<int> row1 = state1[i].empty() ? std::vector<int>(width + 2, 0) : state1[i]; 
+                        std::vector<int> row2 = state2[i].empty() ? std::vector<int>(width + 2, 0) : state2[i]; 
+                        state1[i].swap(row1); 
+                        state2[i].swap(row2); 
+                    }
+                }
+            }
+        }
+
+        void World::activate_tile_and_neighbours(int t){
+            int tr = t / tile_cols; 
+            int tc = t % tile_cols; 
+            for (int dr = -1; dr <= 1; dr++){
+                int r = tr + dr; 
+                if (torus){
+                    // tiles on opposite edges touch through the halo
+                    r = (r + tile_rows) % tile_rows; 
+                } else if (r < 0 || r >= tile_rows){
+                    continue; 
+                }
+                for (int dc = -1; dc <= 1; dc++){
+                    int c = tc + dc; 
+                    if (torus){
+                        c = (c + tile_cols) % tile_cols; 
+                    } else if (c < 0 || c >= tile_cols){
+                        continue; 
+                    }
+                    active[r*tile_cols + c] = 1; 
+                }
+            }
+        }
+
+        void World::activate(int x, int y){
+            activate_tile_and_neighbours(((x-1) / tile_h) * tile_cols + (y-1) / tile_w); 
+        }
+
+        template <class R>
+        bool World::evolve_tile(int t, uint64_t& h, long long& births, long long& deaths, const R& r){
+            int r0 = (t / tile_cols) * tile_h + 1; 
+            int c0 = (t % tile_cols) * tile_w + 1; 
+            int r1 = std::min(r0 + tile_h, height + 1); 
+            int c1 = std::min(c0 + tile_w, width + 1); 
+            Stats& s = tile_stats[t]; 
+            long long population = s.population; 
+            s = Stats(); 
+            s.population = population; 
+            long long tile_births = 0; 
+            long long tile_deaths = 0; 
+            for (int i=r0; i<r1; i++){
+                const int* up = state1[i-1].data(); 
+                const int* mid = state1[i].data(); 
+                const int* dn = state1[i+1].data(); 
+                int* __restrict out = state2[i].data(); 
+                int row_births = 0; 
+                int row_deaths = 0; 
+                int row_alive = 0; 
+                uint32_t old_sum = 0; 
+                uint32_t new_sum = 0; 
+                for (int j=c0; j<c1; j++){
                     int n_sum = 0; //sum of neighbours
-                    n_sum += state1[i-1][j-1]+ state1[i-1][j] + state1[i-1][j+1]
-                    + state1[i][j-1] + state1[i][j+1] + state1[i+1][j-1] + state1[i+1][j] + state1[i+1][j+1]; 
-
-                    if (state1[i][j]==1){
-                        bool alive = n_sum == 2 || n_sum == 3; 
-                        state2[i][j] = alive ? 1 : 0; 
-                        
-                    } else {
-                        bool alive = n_sum == 3; 
-                        state2[i][j] = alive ? 1 : 0; 
+                    n_sum += up[j-1] + up[j] + up[j+1] + mid[j-1] + mid[j+1] + dn[j-1] + dn[j] + dn[j+1]; 
+                    int alive = r.next(n_sum, mid[j]); 
+                    out[j] = alive; 
+                    row_births += alive & ~mid[j]; 
+                    row_deaths += mid[j] & ~alive; 
+                    row_alive |= alive; 
+                    old_sum += col_weight[j] & -uint32_t(mid[j]); 
+                    new_sum += col_weight[j] & -uint32_t(alive); 
+                }
+                if (old_sum != new_sum){
+                    int block = t % tile_cols; 
+                    h ^= hashing::segment(i, block, old_sum) ^ hashing::segment(i, block, new_sum); 
+                }
+                if (row_alive){
+                    add_span(s, i, out + c0, c0, c1); 
+                }
+                tile_births += row_births; 
+                tile_deaths += row_deaths; 
+            }
+            s.population += tile_births - tile_deaths; 
+            births += tile_births; 
+            deaths += tile_deaths; 
+            return tile_births + tile_deaths != 0; 
+        }
+
+        void World::count_row(int t, int i, const int* now, const int* before, int c0, int c1, long long& births, long long& deaths){
+            int row_population = 0; 
+            int row_births = 0; 
+            int row_deaths = 0; 
+            for (int j=0; j<c1-c0; j++){
+                row_population += now[j]; 
+                row_births += now[j] & ~before[j]; 
+                row_deaths += before[j] & ~now[j]; 
+            }
+            tile_stats[t].population += row_population; 
+            births += row_births; 
+            deaths += row_deaths; 
+            if (row_population > 0){
+                add_span(tile_stats[t], i, now, c0, c1); 
+            }
+        }
+
+        void World::recount(){
+            tile_stats.assign(active.size(), Stats()); 
+            long long births = 0; 
+            long long deaths = 0; 
+            for (int i = 1; i <= height; i++){
+                for (int block = 0; block < tile_cols; block++){
+                    int c0 = block * tile_w + 1; 
+                    int c1 = std::min(c0 + tile_w, width + 1); 
+                    // compared with itself, so no births or deaths
+                    count_row(((i - 1) / tile_h) * tile_cols + block, i, &state1[i][c0], &state1[i][c0], c0, c1, births, deaths); 
+                }
+            }
+            sum_tiles(-1, -1); 
+        }
+
+        void World::sum_tiles(long long births, long long deaths){
+            counted = Stats(); 
+            counted.births = births; 
+            counted.deaths = deaths; 
+            for (const Stats& s : tile_stats){
+                if (s.population == 0){
+                    continue; 
+                }
+                if (counted.population == 0){
+                    counted.min_row = s.min_row; 
+                    counted.max_row = s.max_row; 
+                    counted.min_col = s.min_col; 
+                    counted.max_col = s.max_col; 
+                }
+                counted.population += s.population; 
+                counted.min_row = std::min(counted.min_row, s.min_row); 
+                counted.max_row = std::max(counted.max_row, s.max_row); 
+                counted.min_col = std::min(counted.min_col, s.min_col); 
+                counted.max_col = std::max(counted.max_col, s.max_col); 
+            }
+            counted_valid = true; 
+        }
+
+        void World::evolve(){
+            advance(1); 
+        }
+
+        void World::fill_halo(){
+            for (int i=1; i<=height; i++){
+                state1[i][0] = state1[i][width]; 
+                state1[i][width+1] = state1[i][1]; 
+            }
+            // whole rows including the corners, which the columns above just filled
+            std::copy(state1[height].begin(), state1[height].end(), state1[0].begin()); 
+            std::copy(state1[1].begin(), state1[1].end(), state1[height+1].begin()); 
+        }
+
+        template <class R>
+        void World::evolve_rule(const R& r){
+            if (torus){
+                fill_halo(); 
+            }
+            active_list.clear(); 
+            band_start.resize(tile_rows + 1); 
+            for (int t=0; t<(int)active.size(); t++){
+                if (t % tile_cols == 0){
+                    band_start[t / tile_cols] = active_list.size(); 
+                }
+                if (active[t]){
+                    active_list.push_back(t); 
+                }
+            }
+            band_start[tile_rows] = active_list.size(); 
+            int n_active = active_list.size(); 
+            uint64_t h = state_hash; 
+            long long births = 0; 
+            long long deaths = 0; 
+            long long stolen = 0; 
+            // every thread starts on the active tiles of its own band and steals once it ran out
+            int n_threads = 1; 
+#ifdef _OPENMP
+            n_threads = omp_get_max_threads(); 
+#endif
+            queue_start.resize(n_threads + 1); 
+            for (int k=0; k<=n_threads; k++){
+                queue_start[k] = band_start[band_begin(k, n_threads)]; 
+            }
+            scheduler.fill(active_list, queue_start, n_threads); 
+            #pragma omp parallel reduction(^:h) reduction(+:births, deaths, stolen)
+            {
+                int k = 0; 
+#ifdef _OPENMP
+                k = omp_get_thread_num(); 
+#endif
+                for (int t = scheduler.next(k, stolen); t >= 0; t = scheduler.next(k, stolen)){
+                    changed[t] = evolve_tile(t, h, births, deaths, r); 
+                }
+            }
+            tiles_stolen += stolen; 
+            state_hash = h; 
+            sum_tiles(births, deaths); 
+            // next dirty set: every changed tile and its neighbours
+            std::fill(active.begin(), active.end(), 0); 
+            for (int k=0; k<n_active; k++){
+                if (changed[active_list[k]]){
+                    activate_tile_and_neighbours(active_list[k]); 
+                }
+            }
+            tiles_evolved += n_active; 
+            tiles_offered += active.size(); 
+            std::swap(state1, state2); 
+        }
+
+        template <class R>
+        void World::evolve_blocked(int k, const R& r){
+            int block_rows = (height + block_h - 1) / block_h; 
+            int n_blocks = block_rows * tile_cols; 
+            uint64_t h = state_hash; 
+            long long births = 0; 
+            long long deaths = 0; 
+            #pragma omp parallel reduction(^:h) reduction(+:births, deaths)
+            {
+                // scratch of this thread, reused for all of its blocks
+                std::vector<int> buf1; 
+                std::vector<int> buf2; 
+                #pragma omp for schedule(static)
+                for (int b=0; b<n_blocks; b++){
+                    int block = b % tile_cols; 
+                    int r0 = (b / tile_cols) * block_h + 1; 
+                    int r1 = std::min(r0 + block_h, height + 1); 
+                    int c0 = block * tile_w + 1; 
+                    int c1 = std::min(c0 + tile_w, width + 1); 
+                    // block plus halo, clipped to the zero border which stays dead or wrapped on a torus
+                    int lr0 = torus ? r0 - k : std::max(r0 - k, 0); 
+                    int lr1 = torus ? r1 + k : std::min(r1 + k, height + 2); 
+                    int lc0 = torus ? c0 - k : std::max(c0 - k, 0); 
+                    int lc1 = torus ? c1 + k : std::min(c1 + k, width + 2); 
+                    int w = lc1 - lc0; 
+                    buf1.resize(size_t(lr1 - lr0) * w); 
+                    buf2.resize(size_t(lr1 - lr0) * w); 
+                    for (int i=lr0; i<lr1; i++){
+                        if (torus){
+                            wrap_copy(state1[wrap(i, height)], lc0, lc1, width, &buf1[size_t(i - lr0) * w]); 
+                        } else {
+                            std::copy(state1[i].begin() + lc0, state1[i].begin() + lc1, buf1.begin() + size_t(i - lr0) * w); 
+                        }
+                    }
+                    std::copy(buf1.begin(), buf1.end(), buf2.begin()); 
+                    for (int s=1; s<=k; s++){
+                        // cells that are still exact after s generations
+                        int sr0 = torus ? r0 - (k - s) : std::max(r0 - (k - s), 1); 
+                        int sr1 = torus ? r1 + (k - s) : std::min(r1 + (k - s), height + 1); 
+                        int sc0 = torus ? c0 - (k - s) : std::max(c0 - (k - s), 1); 
+                        int sc1 = torus ? c1 + (k - s) : std::min(c1 + (k - s), width + 1); 
+                        for (int i=sr0; i<sr1; i++){
+                            const int* mid = &buf1[size_t(i - lr0) * w]; 
+                            life_row(mid - w, mid, mid + w, &buf2[size_t(i - lr0) * w], sc0 - lc0, sc1 - lc0, r); 
+                        }
+                        std::swap(buf1, buf2); 
+                    }
+                    // the block covers whole tiles, they are counted again from the result
+                    for (int i=r0; i<r1; i += tile_h){
+                        tile_stats[((i - 1) / tile_h) * tile_cols + block] = Stats(); 
+                    }
+                    // write back and hash the segments, state1 still holds the old generation
+                    for (int i=r0; i<r1; i++){
+                        const int* res = &buf1[size_t(i - lr0) * w]; 
+                        // buf2 holds generation k-1, births and deaths are counted against it
+                        count_row(((i - 1) / tile_h) * tile_cols + block, i, &res[c0 - lc0], &buf2[size_t(i - lr0) * w + c0 - lc0], 
+                                  c0, c1, births, deaths); 
+                        const int* old = state1[i].data(); 
+                        int* __restrict out = state2[i].data(); 
+                        uint32_t old_sum = 0; 
+                        uint32_t new_sum = 0; 
+                        for (int j=c0; j<c1; j++){
+                            int alive = res[j - lc0]; 
+                            out[j] = alive; 
+                            old_sum += col_weight[j] & -uint32_t(old[j]); 
+                            new_sum += col_weight[j] & -uint32_t(alive); 
+                        }
+                        if (old_sum != new_sum){
+                            h ^= hashing::segment(i, block, old_sum) ^ hashing::segment(i, block, new_sum); 
+                        }
                     }
                 }
             }
+            state_hash = h; 
+            sum_tiles(births, deaths); 
+            // the net change over k generations hides oscillators, so every tile is dirty again
+            std::fill(active.begin(), active.end(), 1); 
+            tiles_evolved += (long long)active.size() * k; 
+            tiles_offered += (long long)active.size() * k; 
             std::swap(state1, state2); 
         }
 
-        void World::print() {
-            std::cout << "\033[2J\033[H"; // Clear screen
-            int n_height = height+1;
-            int n_width = width+1;
-            
-            for (int i=1; i< n_height; i++) {
-                for (int j=1; j<n_width; j++) {
-                    std::string cell = state1[i][j] == 1 ? "\033[1m\033[32m\u2593\u2593\033[0m\033" : "\033[1m\033[90m\u2591\u2591\033[0m";
-                    std::cout << cell << " ";
+        template <class R>
+        void World::advance_rule(int generations, const R& r){
+            while (generations > 0){
+                int k = std::min(block_depth, generations); 
+                if (k == 1){
+                    evolve_rule(r); 
+                } else {
+                    evolve_blocked(k, r); 
                 }
-                std::cout << std::endl;
+                generations -= k; 
             }
-            
-            std::cout << std::endl;
+        }
+
+        template <uint32_t Birth, uint32_t Survive>
+        bool World::advance_fixed(int generations){
+            if (rule != Rule(Birth, Survive)){
+                return false; 
+            }
+            advance_rule(generations, FixedRule<Birth, Survive>()); 
+            return true; 
+        }
+
+        void World::advance(int generations){
+            if (!counted_valid){
+                recount(); 
+            }
+            // compiled kernels for Life, HighLife, Day & Night and Seeds
+            if (advance_fixed<0x008, 0x00c>(generations) || advance_fixed<0x048, 0x00c>(generations) 
+                || advance_fixed<0x1c8, 0x1d8>(generations) || advance_fixed<0x004, 0x000>(generations)){
+                return; 
+            }
+            advance_rule(generations, AnyRule(rule)); 
+        }
+
+        void World::set_rule(const Rule& rule){
+            if (rule.states != 2){
+                throw std::runtime_error("The world engine only runs two state rules, use the generations engine"); 
+            }
+            this->rule = rule; 
+        }
+
+        void World::set_torus(bool torus){
+            this->torus = torus; 
+            if (!torus && !state1.empty()){
+                // the wrapped copies would otherwise live on as a border of living cells
+                for (std::vector<std::vector<int>>* state : {&state1, &state2}){
+                    for (int i=0; i<height+2; i++){
+                        (*state)[i][0] = (*state)[i][width+1] = 0; 
+                    }
+                    std::fill((*state)[0].begin(), (*state)[0].end(), 0); 
+                    std::fill((*state)[height+1].begin(), (*state)[height+1].end(), 0); 
+                }
+            }
+            // edge tiles now see other neighbours
+            std::fill(active.begin(), active.end(), 1); 
+        }
+
+        void World::set_block_depth(int k){
+            if (k < 1 || k > max_block_depth){
+                throw std::runtime_error("Block depth must be between 1 and " + std::to_string(max_block_depth)); 
+            }
+            block_depth = k; 
+        }
+
+        int World::get_block_depth(){
+            return block_depth; 
+        }
+
+        size_t World::memory(){
+            size_t bytes = 2 * state1.capacity() * sizeof(std::vector<int>); 
+            for (size_t i = 0; i < state1.size(); i++){
+                bytes += (state1[i].capacity() + state2[i].capacity()) * sizeof(int); 
+            }
+            return bytes + active.capacity() + changed.capacity() + active_list.capacity() * sizeof(int) 
+                   + col_weight.capacity() * sizeof(uint32_t); 
+        }
+
+        int World::active_tiles(){
+            return std::count(active.begin(), active.end(), 1); 
+        }
+
+        int World::total_tiles(){
+            return active.size(); 
+        }
+
+        double World::skipped_fraction(){
+            return tiles_offered == 0 ? 0.0 : 1.0 - double(tiles_evolved) / tiles_offered; 
+        }
+
+        double World::stolen_fraction(){
+            return tiles_evolved == 0 ? 0.0 : double(tiles_stolen) / tiles_evolved; 
         }
 
         void World::load(std::string f_path){
@@ -161,17 +596,44 @@
             }
         }
 
-        void World::save(){
-            std::ofstream File("GameState.txt"); 
+        void World::save(std::string f_path){
+            std::ofstream File(f_path); 
             File << height << std::endl; 
             File << width << std::endl; 
-            for (size_t i = 0; i < state1.size(); i++){
-                for (size_t j = 0; j < state1[i].size(); j++){
+            // inner grid only, the border is added again on load
+            for (int i = 1; i <= height; i++){
+                for (int j = 1; j <= width; j++){
                     File << state1[i][j] << " "; 
                 }
                 File << std::endl; 
             }
         }
+        void World::pack(uint64_t* rows){
+            int words = (width + 63) / 64; 
+            #pragma omp parallel for schedule(static)
+            for (int i = 1; i <= height; i++){
+                uint64_t* row = rows + size_t(i - 1) * words; 
+                std::fill(row, row + words, 0); 
+                for (int j = 1; j <= width; j++){
+                    row[(j - 1) / 64] |= uint64_t(state1[i][j]) << ((j - 1) % 64); 
+                }
+            }
+        }
+
+        void World::unpack(const uint64_t* rows){
+            int words = (width + 63) / 64; 
+            #pragma omp parallel for schedule(static)
+            for (int i = 1; i <= height; i++){
+                const uint64_t* row = rows + size_t(i - 1) * words; 
+                for (int j = 1; j <= width; j++){
+                    state1[i][j] = int((row[(j - 1) / 64] >> ((j - 1) % 64)) & 1); 
+                }
+            }
+            std::fill(active.begin(), active.end(), 1); 
+            rehash(); 
+            counted_valid = false; 
+        }
+
         // Generates grid with random 0 1 occurences
         void World::random(double probability) {
         std::random_device rd;
@@ -184,47 +646,68 @@
                 state1[i][j] = dist(gen); // Randomly set to 0 or 1
             }
         }
+        std::fill(active.begin(), active.end(), 1); 
+        rehash(); 
+        counted_valid = false; 
     }
 
-    bool World::is_stable(){
-        std::vector<std::vector<int>> copy = state1; 
-        evolve(); 
-        evolve(); 
-        return state1 == copy; 
+    uint64_t World::hash(){
+        return state_hash; 
+    }
+
+    uint32_t World::segment_sum(int x, int block){
+        uint32_t sum = 0; 
+        for (int j = block * tile_w + 1; j <= std::min((block + 1) * tile_w, width); j++){
+            sum += col_weight[j] & -uint32_t(state1[x][j]); 
+        }
+        return sum; 
+    }
+
+    void World::rehash(){
+        state_hash = 0; 
+        for (int i = 1; i <= height; ++i) {
+            for (int block = 0; block < tile_cols; block++) {
+                state_hash ^= hashing::segment(i, block, segment_sum(i, block)); 
+            }
+        }
     }
 
 
     void World::set(int x, int y){
-        if (x > 0 && x < height && y > 0 && y < width){
+        if (x > 0 && x <= height && y > 0 && y <= width){
+        int block = (y - 1) / tile_w; 
+        state_hash ^= hashing::segment(x, block, segment_sum(x, block)); 
         state1[x][y] = 1; 
+        state_hash ^= hashing::segment(x, block, segment_sum(x, block)); 
+        activate(x, y); 
+        counted_valid = false; 
         }
     }
 
-    void World::set(int index){
-        // Division without rest
-        int row = index / height; 
-        // Get index of column with remainder
-        int column = index - row * height;
-        if (index > 0 && row < height && column < width ){
-        state1[row][column] = 1; 
+    void World::set_run(int x, int y, int n){
+        int first = std::max(y, 1); 
+        int last = int(std::min<long long>((long long)y + n - 1, width)); 
+        if (x < 1 || x > height || first > last){
+            return; 
+        }
+        for (int block = (first - 1) / tile_w; block <= (last - 1) / tile_w; block++){
+            state_hash ^= hashing::segment(x, block, segment_sum(x, block)); 
         }
+        std::fill(state1[x].begin() + first, state1[x].begin() + last + 1, 1); 
+        for (int block = (first - 1) / tile_w; block <= (last - 1) / tile_w; block++){
+            state_hash ^= hashing::segment(x, block, segment_sum(x, block)); 
+            activate(x, block * tile_w + 1); 
+        }
+        counted_valid = false; 
     }
 
     int World::get(int x, int y){ 
-      if (x > 0 && x < height && y > 0 && y < width){  
+      if (x > 0 && x <= height && y > 0 && y <= width){  
         return state1[x][y]; 
       }
       else { return 100; }
     }
   
-    int World::get(int index){
-        int row = index / height; 
-        int column = index - row * height; 
-        if (index > 0 && row < height && index > 0 ){
-        return state1[row][column]; 
-        }
-        else { return 100; }
-    }
 
     
 
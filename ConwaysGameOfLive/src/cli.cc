@@ -1,22 +1,210 @@
 #include "include/cli.h"
 #include <random>
 #include <thread>
+#include <stdexcept>
+#include <algorithm>
+#ifdef _OPENMP
+#include <omp.h>
+#endif
 #include "include/World.h"
+#include "include/HashLife.h"
+#include "include/SparseWorld.h"
+#include "include/GenerationsWorld.h"
+#include "include/BatchWorld.h"
+#include "include/Snapshot.h"
+#include "include/Pattern.h"
+#include "include/RenderThread.h"
+#include "include/History.h"
+#include "include/MappedWorld.h"
+#include "include/Numa.h"
+#include <fstream>
+#include <sstream>
 
-CLI::CLI() : print_delay(100), print_world(false), check_stability(false) {}
+CLI::CLI() : print_world(false), check_stability(false), print_delay(100), world(new World()) {}
 
-void CLI::create(int height, int width) { world = World(height, width); }
+void CLI::create(int height, int width, std::string engine, bool torus) {
+    check_recording(engine, current_rule);
+    std::unique_ptr<Engine> next(make_engine(engine, height, width));
+    next->set_rule(current_rule);
+    next->set_torus(torus);
+    world = std::move(next);
+    this->torus = torus;
+    generation = 0;
+    cycle.reset();
+}
+
+void CLI::engine(std::string name) {
+    check_recording(name, current_rule);
+    std::unique_ptr<Engine> next(make_engine(name, world->get_height(), world->get_width()));
+    next->set_rule(current_rule);
+    next->set_torus(torus);
+    copy_cells(*world, *next);
+    world = std::move(next);
+    // every engine hashes differently
+    cycle.reset();
+    describe_mapped();
+}
+
+void CLI::load(std::string f_path, int x, int y) {
+    std::string name = world->name();
+    std::string format = pattern::format_of(f_path);
+    if (!format.empty()) {
+        place(f_path, format, x, y);
+        return;
+    }
+    if (Snapshot::is_snapshot(f_path)) {
+        SnapshotFile s(f_path);
+        if (name == "mapped" && !s.compressed()) {
+            // raw rows are evolved right where they are
+            world.reset(new MappedWorld(f_path));
+            current_rule = s.rule();
+            torus = false;
+            generation = s.generation();
+            cycle.reset();
+            std::cout << "Mapped " << f_path << ", resuming at generation " << generation << std::endl;
+            return;
+        }
+        std::unique_ptr<Engine> next(make_engine(name, s.height(), s.width()));
+        next->set_rule(s.rule());
+        next->set_torus(s.torus());
+        s.restore(*next);
+        world = std::move(next);
+        current_rule = s.rule();
+        torus = s.torus();
+        generation = s.generation();
+        cycle.reset();
+        describe_mapped();
+        std::cout << "Resuming at generation " << generation << std::endl;
+        return;
+    }
+    if (name == "generations") {
+        // the only engine with more than two states reads them itself
+        std::unique_ptr<Engine> next(new GenerationsWorld(f_path));
+        next->set_rule(current_rule);
+        next->set_torus(torus);
+        world = std::move(next);
+        generation = 0;
+        cycle.reset();
+        return;
+    }
+    world.reset(new World(f_path));
+    world->set_rule(current_rule);
+    world->set_torus(torus);
+    generation = 0;
+    cycle.reset();
+    if (name != "world") {
+        engine(name);
+    }
+}
+
+void CLI::place(std::string f_path, std::string format, int x, int y) {
+    if (world->get_height() == 0) {
+        throw std::runtime_error("Create a world before loading a pattern into it");
+    }
+    std::ifstream f(f_path, std::ios::binary);
+    if (!f) {
+        throw std::runtime_error("Cannot open " + f_path);
+    }
+    long long cells;
+    if (format == "rle") {
+        Rule rule;
+        cells = pattern::read_rle(f, *world, x, y, rule);
+        if (!(rule == current_rule)) {
+            check_recording(world->name(), rule);
+            world->set_rule(rule);
+            current_rule = rule;
+            std::cout << "Rule " << rule.str() << " from the pattern" << std::endl;
+        }
+    } else {
+        cells = pattern::read_cells(f, *world, x, y);
+    }
+    cycle.reset();
+    std::cout << "Read " << cells << " living cells, placed from " << x << " " << y << std::endl;
+}
+
+void CLI::save(std::string f_path, std::string format) {
+    if (format.empty()) {
+        bool binary = f_path.size() > 5 && f_path.compare(f_path.size() - 5, 5, ".snap") == 0;
+        std::string pattern = pattern::format_of(f_path);
+        format = binary ? "rle" : pattern == "rle" ? "golly" : pattern == "cells" ? "cells" : "text";
+    }
+    if (format == "text") {
+        world->save(f_path);
+        return;
+    }
+    if (format == "golly" || format == "cells") {
+        std::ofstream f(f_path);
+        if (format == "golly") {
+            pattern::write_rle(f, *world, current_rule);
+        } else {
+            pattern::write_cells(f, *world);
+        }
+        if (!f.flush()) {
+            throw std::runtime_error("Cannot write " + f_path);
+        }
+        return;
+    }
+    if (format != "binary" && format != "rle") {
+        throw std::runtime_error("Unknown format " + format + ", use text, binary, rle, golly or cells");
+    }
+    Snapshot s;
+    s.capture(*world, generation, current_rule, torus);
+    s.write(f_path, format == "rle");
+}
+
+void CLI::checkpoint(std::string f_path, long long generations, double seconds) {
+    if (generations < 0 || seconds < 0) {
+        throw std::runtime_error("Checkpoint intervals must not be negative");
+    }
+    // the old writer finishes its last checkpoint first
+    checkpoints.reset();
+    if (generations > 0 || seconds > 0) {
+        checkpoints.reset(new Checkpointer(f_path, generations, seconds, generation));
+        try {
+            check_recording(world->name(), current_rule);
+        } catch (...) {
+            checkpoints.reset();
+            throw;
+        }
+    }
+}
 
-void CLI::load(std::string f_path) { world = World(f_path); }
+void CLI::map_file(std::string f_path) {
+    MappedWorld::default_path = f_path;
+}
+
+void CLI::describe_mapped() {
+    MappedWorld* mapped = dynamic_cast<MappedWorld*>(world.get());
+    if (mapped != nullptr) {
+        mapped->describe(generation, current_rule, torus);
+    }
+}
 
-void CLI::save(std::string f_path) {
-   world.load(f_path); 
+void CLI::checkpoint_if_due() {
+    if (!checkpoints) {
+        return;
+    }
+    if (checkpoints->due(generation)) {
+        checkpoints->capture(*world, generation, current_rule, torus);
+    }
+    std::string failure = checkpoints->error();
+    if (!failure.empty()) {
+        std::cout << "Checkpoint failed: " << failure << std::endl;
+    }
 }
 
 void CLI::print(int setting) {
     print_world = (setting == 1);
     if (print_world) {
-        world.print();
+        renderer.reset();
+        renderer.draw(*world, current_rule.states);
+    }
+}
+
+void CLI::zoom(int k, int top, int left) {
+    renderer.set_zoom(k, top, left);
+    if (print_world) {
+        renderer.draw(*world, current_rule.states);
     }
 }
 
@@ -24,67 +212,367 @@ void CLI::delay(int ms) {
     print_delay = ms;
 }
 
+void CLI::pipeline(int setting) {
+    pipelined = (setting == 1);
+}
+
+void CLI::threads(int n) {
+#ifdef _OPENMP
+    omp_set_num_threads(n);
+    if (numa::pinned()) {
+        numa::pin_threads();
+    }
+#else
+    if (n != 1) {
+        throw std::runtime_error("Built without OpenMP, only 1 thread available");
+    }
+#endif
+    // the rows follow their threads to the nodes they run on now
+    World* w = dynamic_cast<World*>(world.get());
+    if (w != nullptr) {
+        w->place_rows();
+    }
+}
+
+void CLI::pin(int setting) {
+    if (setting == 1) {
+        if (!numa::pin_threads()) {
+            throw std::runtime_error("Threads can only be pinned on Linux with OpenMP");
+        }
+    } else {
+        numa::unpin_threads();
+    }
+    World* w = dynamic_cast<World*>(world.get());
+    if (w != nullptr) {
+        w->place_rows();
+    }
+}
+
+void CLI::tiles() {
+    World* w = dynamic_cast<World*>(world.get());
+    if (w == nullptr) {
+        throw std::runtime_error("Tile tracking is only done by the world engine");
+    }
+    int active = w->active_tiles();
+    int total = w->total_tiles();
+    std::cout << "Tiles of " << World::tile_h << "x" << World::tile_w << " cells: " << active << " of " << total
+              << " active for the next generation, " << 100.0 * w->skipped_fraction()
+              << "% skipped so far, " << 100.0 * w->stolen_fraction() << "% of the evolved ones stolen by idle threads"
+              << std::endl;
+}
+
+void CLI::block(int k) {
+    World* w = dynamic_cast<World*>(world.get());
+    if (w == nullptr) {
+        throw std::runtime_error("Temporal blocking is only done by the world engine");
+    }
+    w->set_block_depth(k);
+}
+
+void CLI::rule(std::string text) {
+    Rule next = Rule::parse(text);
+    check_recording(world->name(), next);
+    world->set_rule(next);
+    current_rule = next;
+    cycle.reset();
+    std::cout << "Rule " << next.str() << " on the " << world->name() << " engine" << std::endl;
+}
+
 void CLI::stability(int x) {
     check_stability = (x == 1);
 }
 
-double CLI::run(int gen) {
+std::string CLI::engine_name() {
+    return world->name();
+}
+
+long long CLI::world_size() {
+    return (long long)world->get_height() * world->get_width();
+}
+
+double CLI::run(int& gen, std::string engine, std::string until) {
+    if (!until.empty() && until != "empty" && until != "period" && until != "grow") {
+        throw std::runtime_error("Unknown condition " + until + ", use empty, period or grow");
+    }
+    if (!engine.empty() && engine != world->name()) {
+        this->engine(engine);
+    }
+    describe_mapped();
+    // the engines count while they evolve, so checking the condition reads no cells
+    Stats first = world->stats();
     auto start = std::chrono::high_resolution_clock::now();
-    for (int i = 0; i < gen; i++) {
-        if (print_world) {
-            world.print();
+    bool unobserved = !print_world && !check_stability && until.empty() && !history;
+    if (unobserved) {
+        // nothing to look at between generations, so the engine may block them up to the next checkpoint
+        for (int done = 0; done < gen;) {
+            int chunk = checkpoints ? int(std::min<long long>(gen - done, checkpoints->until_due(generation))) : gen - done;
+            world->advance(chunk);
+            generation += chunk;
+            done += chunk;
+            checkpoint_if_due();
         }
-        if (check_stability && world.is_stable()) {
-            std::cout << "World is stable after " << i << " generations" << std::endl;
+    }
+    int steps = unobserved ? gen : 0;
+    // anything printed since the last frame scrolled it, so the run starts on a clear screen
+    renderer.reset();
+    // drawing, waiting and handing frames over are left out of the time reported
+    std::chrono::duration<double> idle(0);
+    std::unique_ptr<RenderThread> drawer;
+    if (print_world && pipelined && steps < gen) {
+        drawer.reset(new RenderThread(renderer, print_delay));
+        drawer->publish(*world, generation);
+    }
+    bool framed = print_world && !drawer;
+    // messages wait for the end of the run, the render thread may be drawing meanwhile
+    std::ostringstream report;
+    if (history && steps < gen) {
+        // the world may have been edited or rewound since it was recorded
+        history->record(*world, generation);
+    }
+    for (; steps < gen; steps++) {
+        if (framed) {
+            auto drawing = std::chrono::high_resolution_clock::now();
+            renderer.draw(*world, current_rule.states);
+            idle += std::chrono::high_resolution_clock::now() - drawing;
+        }
+        if ((check_stability || until == "period") && cycle.push(world->hash(), generation)) {
+            if (cycle.period() == 1) {
+                report << "World is stable after " << steps << " generations";
+            } else {
+                report << "World oscillates with period " << cycle.period() << " after " << steps << " generations";
+            }
+            report << ", the cycle started at generation " << cycle.start() << std::endl;
             break;
         }
-        world.evolve();
-        if (print_world) {
+        world->evolve();
+        generation++;
+        if (history) {
+            history->record(*world, generation);
+        }
+        if (drawer) {
+            auto publishing = std::chrono::high_resolution_clock::now();
+            drawer->publish(*world, generation);
+            idle += std::chrono::high_resolution_clock::now() - publishing;
+        }
+        checkpoint_if_due();
+        if (until == "empty" || until == "grow") {
+            Stats now = world->stats();
+            if (until == "empty" && now.population == 0) {
+                report << "Population is zero at generation " << generation << std::endl;
+                steps++;
+                break;
+            }
+            // a spaceship moves its box without growing it
+            if (until == "grow" && (now.box_height() > first.box_height() || now.box_width() > first.box_width())) {
+                report << "Bounding box grew to " << now.box_height() << "x" << now.box_width()
+                       << " at generation " << generation << std::endl;
+                steps++;
+                break;
+            }
+        }
+        if (framed) {
+            auto waiting = std::chrono::high_resolution_clock::now();
             std::this_thread::sleep_for(std::chrono::milliseconds(print_delay));
+            idle += std::chrono::high_resolution_clock::now() - waiting;
         }
     }
+    gen = steps;
+    auto end = std::chrono::high_resolution_clock::now();
+    if (drawer) {
+        long long drawn;
+        long long dropped;
+        drawer->finish(drawn, dropped);
+        // the last generation may have found the ring full
+        renderer.draw(*world, current_rule.states);
+        report << "Drew " << drawn + 1 << " frames, dropped " << dropped << std::endl;
+    }
+    std::cout << report.str();
+    std::chrono::duration<double> duration = end - start;
+    return (duration - idle).count();
+}
+
+void CLI::keep_history(double megabytes, long long interval) {
+    if (megabytes < 0 || interval < 1) {
+        throw std::runtime_error("The history needs a budget of at least 0 MB and a keyframe interval of at least 1");
+    }
+    history.reset();
+    if (megabytes > 0) {
+        history.reset(new History(size_t(megabytes * 1024 * 1024), interval));
+        try {
+            check_recording(world->name(), current_rule);
+        } catch (...) {
+            history.reset();
+            throw;
+        }
+    }
+}
+
+void CLI::check_recording(const std::string& name, const Rule& rule) {
+    if (!history && !checkpoints) {
+        return;
+    }
+    std::string what = history ? "The history keeps" : "Checkpoints keep";
+    std::string off = history ? "history off" : "checkpoint off";
+    // a rewind or resume would keep only the cells inside the window of these engines
+    if (name == "hashlife" || name == "sparse") {
+        throw std::runtime_error(what + " only bounded grids, the " + name
+                                 + " engine runs on an unbounded plane. Use " + off + " or another engine");
+    }
+    // and only the living cells, not the decaying states
+    if (rule.states > 2) {
+        throw std::runtime_error(what + " only living cells, " + rule.str() + " has "
+                                 + std::to_string(rule.states) + " states. Use " + off + " or a Life-like rule");
+    }
+}
+
+void CLI::go_to(long long target) {
+    if (!history || !history->has(target)) {
+        std::string kept = history && history->first() >= 0
+            ? ", it holds " + std::to_string(history->first()) + " to " + std::to_string(history->last()) : "";
+        throw std::runtime_error("Generation " + std::to_string(target) + " is not in the history" + kept);
+    }
+    std::unique_ptr<Engine> next(make_engine(world->name(), world->get_height(), world->get_width()));
+    next->set_rule(current_rule);
+    next->set_torus(torus);
+    World* blocked = dynamic_cast<World*>(world.get());
+    if (blocked != nullptr) {
+        dynamic_cast<World&>(*next).set_block_depth(blocked->get_block_depth());
+    }
+    history->restore(target, *next);
+    world = std::move(next);
+    generation = target;
+    cycle.reset();
+    describe_mapped();
+    if (print_world) {
+        renderer.reset();
+        renderer.draw(*world, current_rule.states);
+    }
+    std::cout << "At generation " << generation << ", history holds " << history->first() << " to "
+              << history->last() << " in " << history->memory() / 1024 << " KB with "
+              << history->keyframes() << " keyframes" << std::endl;
+}
+
+void CLI::rewind(long long n) {
+    go_to(generation - n);
+}
+
+void CLI::stats() {
+    Stats s = world->stats();
+    std::cout << "Generation " << generation << ": population " << s.population;
+    if (s.births >= 0) {
+        std::cout << ", " << s.births << " births, " << s.deaths << " deaths";
+    }
+    if (s.population > 0) {
+        std::cout << ", bounding box " << s.box_height() << "x" << s.box_width() << " from (" << s.min_row << ", "
+                  << s.min_col << ") to (" << s.max_row << ", " << s.max_col << ")";
+    }
+    std::cout << std::endl;
+}
+
+double CLI::jump(unsigned long long gen) {
+    if (history) {
+        throw std::runtime_error("jump skips the generations in between, so the history cannot keep them. Use history off first");
+    }
+    if (std::string(world->name()) != "hashlife") {
+        engine("hashlife");
+        std::cout << "Switched to hashlife engine" << std::endl;
+    }
+    HashLife* hl = static_cast<HashLife*>(world.get());
+    auto start = std::chrono::high_resolution_clock::now();
+    hl->jump(gen);
+    generation += gen;
+    cycle.reset();
+    checkpoint_if_due();
+    auto end = std::chrono::high_resolution_clock::now();
+    std::chrono::duration<double> duration = end - start;
+    std::cout << "Population " << hl->population() << ", " << hl->node_count() << " nodes cached, "
+              << hl->collections() << " collections" << std::endl;
+    return duration.count();
+}
+
+double CLI::batch(int lanes, int height, int width, long long gen, double density) {
+    BatchWorld batch(height, width, lanes);
+    batch.random(density);
+    auto start = std::chrono::high_resolution_clock::now();
+    batch.run(gen);
     auto end = std::chrono::high_resolution_clock::now();
     std::chrono::duration<double> duration = end - start;
+    const std::vector<BatchResult>& results = batch.results();
+    int settled = 0;
+    int still = 0;
+    long long slowest = 0;
+    for (int lane = 0; lane < lanes; lane++) {
+        const BatchResult& r = results[lane];
+        std::cout << "World " << lane << ": ";
+        if (r.period == 0) {
+            std::cout << "population " << batch.population(lane) << ", not settled" << std::endl;
+            continue;
+        }
+        std::cout << "population " << r.population << ", period " << r.period
+                  << ", settled by generation " << r.generation << std::endl;
+        settled++;
+        still += r.period == 1;
+        slowest = std::max(slowest, r.generation);
+    }
+    std::cout << settled << " of " << lanes << " worlds settled (" << still << " still, " << settled - still
+              << " oscillating), the last one by generation " << slowest << ", " << batch.get_generation()
+              << " generations with the " << batch.kernel() << " kernel" << std::endl;
     return duration.count();
 }
 
+void CLI::view(long long row, long long col) {
+    SparseWorld* sw = dynamic_cast<SparseWorld*>(world.get());
+    if (sw == nullptr) {
+        throw std::runtime_error("Only the sparse engine has a movable window");
+    }
+    sw->view(row, col);
+    std::cout << "Population " << sw->population() << " in " << sw->chunk_count() << " chunks" << std::endl;
+    if (print_world) {
+        renderer.reset();
+        renderer.draw(*world, current_rule.states);
+    }
+}
+
 void CLI::set(int x, int y, int alive) {
-    int height = world.get_height();
-    int width = world.get_width();
+    cycle.reset();
+    int height = world->get_height();
+    int width = world->get_width();
     // Toroidal wrapping
     int wrapped_x = (x - 1) % height + 1;
     int wrapped_y = (y - 1) % width + 1;
     if (wrapped_x < 1) wrapped_x += height;
     if (wrapped_y < 1) wrapped_y += width;
     if (alive > 0) {
-        world.set(wrapped_x, wrapped_y);
+        world->set(wrapped_x, wrapped_y);
     }
 }
 
 void CLI::set(int index, int alive) {
+    cycle.reset();
     if (alive > 0) {
-        world.set(index);
+        world->set(index);
     }
 }
 
 void CLI::get(int x, int y) {
-    int height = world.get_height();
-    int width = world.get_width();
+    int height = world->get_height();
+    int width = world->get_width();
     // Toroidal wrapping
     int wrapped_x = (x - 1) % height + 1;
     int wrapped_y = (y - 1) % width + 1;
     if (wrapped_x < 1) wrapped_x += height;
     if (wrapped_y < 1) wrapped_y += width;
-    std::cout << world.get(wrapped_x, wrapped_y) << std::endl;
+    std::cout << world->get(wrapped_x, wrapped_y) << std::endl;
 }
 
 void CLI::get(int index) {
-    std::cout << world.get(index) << std::endl;
+    std::cout << world->get(index) << std::endl;
 }
 
 void CLI::glider(int x, int y) {
-    int height = world.get_height();
-    int width = world.get_width();
+    cycle.reset();
+    int height = world->get_height();
+    int width = world->get_width();
     // Toroidal wrapping for anchor cell
     int base_x = (x - 1) % height + 1;
     int base_y = (y - 1) % width + 1;
@@ -104,13 +592,14 @@ void CLI::glider(int x, int y) {
         int new_y = (base_y + dy - 1) % width + 1;
         if (new_x < 1) new_x += height;
         if (new_y < 1) new_y += width;
-        world.set(new_x, new_y);
+        world->set(new_x, new_y);
     }
 }
 
 void CLI::toad(int x, int y) {
-    int height = world.get_height();
-    int width = world.get_width();
+    cycle.reset();
+    int height = world->get_height();
+    int width = world->get_width();
     int base_x = (x - 1) % height + 1;
     int base_y = (y - 1) % width + 1;
     if (base_x < 1) base_x += height;
@@ -127,13 +616,14 @@ void CLI::toad(int x, int y) {
         int new_y = (base_y + dy - 1) % width + 1;
         if (new_x < 1) new_x += height;
         if (new_y < 1) new_y += width;
-        world.set(new_x, new_y);
+        world->set(new_x, new_y);
     }
 }
 
 void CLI::beacon(int x, int y) {
-    int height = world.get_height();
-    int width = world.get_width();
+    cycle.reset();
+    int height = world->get_height();
+    int width = world->get_width();
     int base_x = (x - 1) % height + 1;
     int base_y = (y - 1) % width + 1;
     if (base_x < 1) base_x += height;
@@ -152,13 +642,14 @@ void CLI::beacon(int x, int y) {
         int new_y = (base_y + dy - 1) % width + 1;
         if (new_x < 1) new_x += height;
         if (new_y < 1) new_y += width;
-        world.set(new_x, new_y);
+        world->set(new_x, new_y);
     }
 }
 
 void CLI::methuselah(int x, int y) {
-    int height = world.get_height();
-    int width = world.get_width();
+    cycle.reset();
+    int height = world->get_height();
+    int width = world->get_width();
     int base_x = (x - 1) % height + 1;
     int base_y = (y - 1) % width + 1;
     if (base_x < 1) base_x += height;
@@ -176,7 +667,7 @@ void CLI::methuselah(int x, int y) {
         int new_y = (base_y + dy - 1) % width + 1;
         if (new_x < 1) new_x += height;
         if (new_y < 1) new_y += width;
-        world.set(new_x, new_y);
+        world->set(new_x, new_y);
     }
 }
 
@@ -184,8 +675,8 @@ void CLI::random(int n) {
     std::random_device rd;
     std::mt19937 gen(rd());
     std::uniform_int_distribution<> pattern_dist(0, 3); // 4 patterns
-    std::uniform_int_distribution<> x_dist(1, world.get_height());
-    std::uniform_int_distribution<> y_dist(1, world.get_width());
+    std::uniform_int_distribution<> x_dist(1, world->get_height());
+    std::uniform_int_distribution<> y_dist(1, world->get_width());
 
     for (int i = 0; i < n; i++) {
         int pattern = pattern_dist(gen);
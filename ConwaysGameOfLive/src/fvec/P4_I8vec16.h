@@ -0,0 +1,58 @@
+#ifndef L1Algo_I8vec16P4_H
+#define L1Algo_I8vec16P4_H
+
+#include <emmintrin.h>
+#include "P4_F32vec4.h"
+
+/**********************************
+ *
+ *   Vector of sixteen unsigned bytes
+ *
+ **********************************/
+
+class I8vec16
+{
+ public:
+
+  __m128i v;
+
+  unsigned char & operator[]( int i ){ return (reinterpret_cast<unsigned char*>(&v))[i]; }
+  unsigned char   operator[]( int i ) const { return (reinterpret_cast<const unsigned char*>(&v))[i]; }
+
+  I8vec16( ):v(_mm_setzero_si128()){}
+  I8vec16( const __m128i &a ):v(a) {}
+  I8vec16( const unsigned char &a ):v(_mm_set1_epi8(static_cast<char>(a))) {}
+
+  /* Conversion function */
+  operator  __m128i() const { return v; }		/* Convert to __m128i */
+
+  /* Memory access, p does not need to be aligned */
+  static I8vec16 load( const unsigned char *p ){ return _mm_loadu_si128(reinterpret_cast<const __m128i*>(p)); }
+  friend void store( unsigned char *p, const I8vec16 &a ){ _mm_storeu_si128(reinterpret_cast<__m128i*>(p), a); }
+
+  /* Arithmetic Operators, wrap around modulo 256 */
+  friend I8vec16 operator +(const I8vec16 &a, const I8vec16 &b) { return _mm_add_epi8(a,b); }
+  friend I8vec16 operator -(const I8vec16 &a, const I8vec16 &b) { return _mm_sub_epi8(a,b); }
+
+  /* Logical */
+  friend I8vec16 operator&( const I8vec16 &a, const I8vec16 &b ){ return _mm_and_si128(a, b); }
+  friend I8vec16 operator|( const I8vec16 &a, const I8vec16 &b ){ return _mm_or_si128(a, b); }
+  friend I8vec16 operator^( const I8vec16 &a, const I8vec16 &b ){ return _mm_xor_si128(a, b); }
+
+  /* Comparison */
+  friend I8vec16 operator==( const I8vec16 &a, const I8vec16 &b ){ // mask returned
+    return _mm_cmpeq_epi8(a, b);
+  }
+
+  friend std::ostream & operator<<(std::ostream &strm, const I8vec16 &a ){
+    strm<<"[";
+    for (int i = 0; i < 16; i++) strm<<int(a[i])<<(i < 15 ? " " : "]");
+    return strm;
+  }
+
+} __attribute__ ((aligned(16)));
+
+typedef I8vec16 i8vec;
+const int i8vecLen = 16;
+
+#endif
@@ -0,0 +1,95 @@
+#ifndef BATCHWORLD_H
+#define BATCHWORLD_H
+#include <cstdint>
+#include <cstddef>
+#include <vector>
+
+// Final state of one world of a batch
+struct BatchResult {
+    long long population = 0;
+    long long period = 0;     // 1 for a still life, 0 if the world did not settle
+    long long generation = 0; // generation at which the cycle was found
+};
+
+class BatchWorld {
+    /* Many independent worlds of the same size evolved at once, bit-sliced: every
+    cell is a group of words and bit L of the group belongs to world L, so one
+    bitwise adder tree per cell advances all worlds. 64 worlds use one word per
+    cell, 256 worlds four words that the AVX2 kernel handles as one register.
+    Each world has a zero border as in World.
+
+    Stabilization uses Brent's method for all worlds together: a copy of the
+    generation is taken after windows of doubling length and every generation in
+    between is compared with it, the first match of a world gives its exact period.
+    The window stops doubling at max_window, so a world is found at most two windows
+    after its cycle started, and periods longer than that are not detected */
+    private:
+
+        static const long long max_window = 1024;
+
+        int height;
+        int width;
+        int lanes;
+        int groups; // words per cell
+
+        std::vector<uint64_t> state1;
+        std::vector<uint64_t> state2;
+
+        std::vector<uint64_t> snapshot;
+        long long snapshot_generation = 0;
+        long long window = 1;
+
+        long long generation = 0;
+        bool edited = true;            // cells changed since the last snapshot
+        std::vector<uint64_t> settled; // one bit per world
+        std::vector<BatchResult> result;
+
+        size_t index(int x, int y) { return (size_t(x) * (width + 2) + y) * groups; }
+
+        // Forget settled worlds and start over from the current generation
+        void restart();
+
+        void detect();
+
+    public:
+
+        // lanes is the number of worlds, 64 or 256
+        BatchWorld(int height, int width, int lanes);
+
+        int get_lanes();
+
+        // Every world gets its own random soup
+        void random(double probability = 0.3);
+
+        void set(int lane, int x, int y);
+
+        int get(int lane, int x, int y);
+
+        // All worlds one generation, then records the worlds that settled
+        void evolve();
+
+        // Evolve until every world settled or max_generations more have passed
+        void run(long long max_generations);
+
+        bool all_settled();
+
+        long long get_generation();
+
+        // Indexed by lane, valid for settled worlds
+        const std::vector<BatchResult>& results();
+
+        long long population(int lane);
+
+        // Name of the kernel evolve uses for this number of worlds on this CPU
+        const char* kernel();
+};
+
+namespace batchlife {
+    /* One generation of 256 worlds, cells of four words laid out as in BatchWorld.
+    The AVX2 kernel advances a cell with one register per neighbour */
+    void evolve_avx2(const uint64_t* in, uint64_t* out, int height, int width);
+
+    void evolve_256(const uint64_t* in, uint64_t* out, int height, int width);
+}
+
+#endif
@@ -0,0 +1,66 @@
+#ifndef BENCHMARK_H
+#define BENCHMARK_H
+#include <string>
+#include <vector>
+#include <iostream>
+#include <cstddef>
+
+class Benchmark {
+    /* Headless benchmark, run as `game --bench [flags]`. Sweeps every combination
+    of grid size, engine, density and thread count: a random world is filled,
+    evolved for the warm-up generations and then timed over several repeats of the
+    measured generations. Nothing is printed or delayed while timing. Results go
+    out as JSON or CSV, progress to stderr */
+    private:
+
+        struct Result {
+            std::string engine;
+            int height;
+            int width;
+            double density;
+            int threads;
+            double seconds;     // median over the repeats
+            double seconds_min;
+            double cells_per_second;
+            double ns_per_cell;
+            size_t memory;      // Engine::memory after the last repeat
+            size_t peak_rss;    // of the whole process so far, 0 where unknown
+            /* Estimates, nothing is measured: the bytes streamed per second if every
+            generation reads and writes the whole engine once, an upper bound for engines
+            that skip quiet regions, and that figure split over the NUMA nodes by the
+            share of the team running on each. Written as est_* columns */
+            double bandwidth;
+            std::vector<double> node_bandwidth;
+        };
+
+        std::vector<std::pair<int, int>> sizes; // height, width
+        std::vector<std::string> engines;
+        std::vector<double> densities;
+        std::vector<int> threads;
+        int generations = 100;
+        int warmup = 10;
+        int repeat = 3;
+        bool pin = true;
+        std::string format = "json";
+        std::string output;
+
+        std::vector<Result> results;
+
+        Result measure(const std::string& engine, int height, int width, double density, int n_threads);
+
+        void write_json(std::ostream& out);
+
+        void write_csv(std::ostream& out);
+
+    public:
+
+        // Parses the flags after --bench, throws std::runtime_error for bad ones
+        Benchmark(int argc, char** argv);
+
+        // Runs the sweep and writes the results, returns the exit code of the program
+        int run();
+
+        static void usage(std::ostream& out);
+};
+
+#endif
@@ -0,0 +1,57 @@
+#ifndef BITLIFE_H
+#define BITLIFE_H
+#include <cstdint>
+
+namespace bitlife {
+    /* Word-parallel B3/S23 kernel: bit b of a word is one cell, bit b-1 its western
+    and bit b+1 its eastern neighbour. The *_l / *_r words are the neighbouring words
+    of the same row, they supply the bits shifted in across the word edges */
+
+    inline uint64_t west(uint64_t w, uint64_t l) {
+        return (w << 1) | (l >> 63);
+    }
+
+    inline uint64_t east(uint64_t w, uint64_t r) {
+        return (w >> 1) | (r << 63);
+    }
+
+    // Bitwise adders, W is any type with & | ^ ~ such as uint64_t or a SIMD register
+    template <class W>
+    inline void full_add(W a, W b, W c, W& sum, W& carry) {
+        W t = a ^ b;
+        sum = t ^ c;
+        carry = (a & b) | (t & c);
+    }
+
+    /* Next state of the cells in mid from their 8 neighbours, one cell per bit. The
+    neighbours may be shifted copies of the same rows, as in step, or other words */
+    template <class W>
+    inline W life(W up_w, W up, W up_e, W w, W mid, W e, W dn_w, W dn, W dn_e) {
+        W s_up, c_up, s_dn, c_dn;
+        full_add(up_w, up, up_e, s_up, c_up);
+        full_add(dn_w, dn, dn_e, s_dn, c_dn);
+        W s_mid = w ^ e;
+        W c_mid = w & e;
+
+        // weight 1 and weight 2 bits of the neighbour count, ge4 flags counts >= 4
+        W ones, c_ones, t_sum, t_carry;
+        full_add(s_up, s_dn, s_mid, ones, c_ones);
+        full_add(c_up, c_dn, c_mid, t_sum, t_carry);
+        W twos = t_sum ^ c_ones;
+        W ge4 = t_carry | (t_sum & c_ones);
+
+        // alive with 2 or 3 neighbours, or dead with exactly 3
+        return twos & ~ge4 & (ones | mid);
+    }
+
+    // Next state of the 64 cells in mid
+    inline uint64_t step(uint64_t up_l, uint64_t up, uint64_t up_r,
+                         uint64_t mid_l, uint64_t mid, uint64_t mid_r,
+                         uint64_t dn_l, uint64_t dn, uint64_t dn_r) {
+        return life(west(up, up_l), up, east(up, up_r),
+                    west(mid, mid_l), mid, east(mid, mid_r),
+                    west(dn, dn_l), dn, east(dn, dn_r));
+    }
+}
+
+#endif
@@ -0,0 +1,137 @@
+#ifndef BYTEWORLD_H
+#define BYTEWORLD_H
+#include <cstdint>
+#include <cstddef>
+#include <vector>
+#include <cstring>
+
+#include "Engine.h"
+#include "Hash.h"
+#include "Census.h"
+#include "../fvec/P4_I8vec16.h"
+#ifdef __AVX2__
+#include <immintrin.h>
+#endif
+
+class ByteWorld : public Engine {
+    /* One byte per cell in a flat buffer. Every row starts with 32 bytes of zero halo,
+    so column 1 sits on a vector boundary, and is padded on the right to a multiple of
+    32 cells plus another 32 byte halo. One zero row above and below completes the
+    border, the kernels then load whole vectors without edge cases */
+    protected:
+
+        int height;
+        int width;
+        size_t stride;
+
+        std::vector<uint8_t, nsL1::SimdAlloc<uint8_t> > state1;
+        std::vector<uint8_t, nsL1::SimdAlloc<uint8_t> > state2;
+
+        // xor of the bytelife::row_hash keys of state1, kept by evolve
+        uint64_t state_hash = 0;
+
+        void rehash();
+
+        // column 1 is at offset halo of its row
+        uint8_t& cell(int x, int y) { return state1[size_t(x) * stride + halo - 1 + y]; }
+
+    public:
+
+        // Offset of column 1 inside a row
+        static const int halo = 32;
+
+        ByteWorld();
+        ByteWorld(int height, int width);
+
+        const char* name() override { return "byte"; }
+
+        int get_height() override;
+
+        int get_width() override;
+
+        void evolve() override;
+
+        uint64_t hash() override;
+
+        size_t memory() override;
+
+        void random(double probability = 0.3) override;
+
+        void pack(uint64_t* rows) override;
+
+        void unpack(const uint64_t* rows) override;
+
+        using Engine::set;
+        using Engine::get;
+
+        void set(int x, int y) override;
+
+        void set_run(int x, int y, int n) override;
+
+        int get(int x, int y) override;
+
+        // Name of the kernel evolve() dispatches to on this CPU
+        static const char* kernel();
+};
+
+namespace bytelife {
+    /* Compute rows 1..height of out from in, both laid out as in ByteWorld, return
+    the hash of out and count out against in into tally. The AVX2 kernel handles
+    32 cells per instruction, the SSE one 16 */
+    uint64_t evolve_avx2(const uint8_t* in, uint8_t* out, int height, int width, size_t stride, census::Tally& tally);
+
+    uint64_t evolve_sse(const uint8_t* in, uint8_t* out, int height, int width, size_t stride, census::Tally& tally);
+
+    // hashing::row key of one row, row points at column 1 of row i
+    inline uint64_t row_hash(const uint8_t* row, int width, int i) {
+        // four independent folds keep the multiplies from waiting on each other
+        uint64_t acc[4] = {0, 0, 0, 0};
+        for (int j = 0; j < width; j += 32) {
+            for (int k = 0; k < 4; k++) {
+                uint64_t w;
+                std::memcpy(&w, row + j + 8 * k, 8);
+                acc[k] = hashing::fold(acc[k], w);
+            }
+        }
+        return hashing::row(i, acc[0] ^ hashing::mix64(acc[1] ^ hashing::mix64(acc[2] ^ hashing::mix64(acc[3]))));
+    }
+
+    bool has_avx2();
+
+    /* The kernels count living and changed cells with one byte counter per vector
+    lane, summed up every count_block vectors before a counter can overflow */
+    const int count_block = 255;
+
+    // Lanes of the last vector of a row of width cells that are still in the row get value
+    inline void last_lanes(uint8_t* lanes, int n, int width, uint8_t value) {
+        for (int k = 0; k < n; k++) {
+            lanes[k] = k <= (width - 1) % n ? value : 0;
+        }
+    }
+
+    // Sum of the 64-bit lanes of a counter
+    inline long long lane_sum(__m128i v) {
+        return _mm_cvtsi128_si64(v) + _mm_cvtsi128_si64(_mm_unpackhi_epi64(v, v));
+    }
+
+#ifdef __AVX2__
+    inline long long lane_sum(__m256i v) {
+        return lane_sum(_mm_add_epi64(_mm256_castsi256_si128(v), _mm256_extracti128_si256(v, 1)));
+    }
+#endif
+
+    // Adds the living cells of a row to the bounding box of tally, row points at column 1
+    inline void span_row(census::Tally& tally, int i, const uint8_t* row, int width) {
+        int first = 0;
+        while (row[first] != 1) {
+            first++;
+        }
+        int last = width - 1;
+        while (row[last] != 1) {
+            last--;
+        }
+        tally.span(i, first + 1, last + 1);
+    }
+}
+
+#endif
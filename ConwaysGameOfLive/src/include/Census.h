@@ -0,0 +1,54 @@
+#ifndef CENSUS_H
+#define CENSUS_H
+#include <cstdint>
+#include <limits>
+#include <algorithm>
+
+#include "Engine.h"
+
+namespace census {
+    /* Running totals for Stats, filled by the kernels from rows that were just
+    written and are still in cache, so counting adds no pass over memory. Births and
+    deaths come from the cells that changed and the population before, which saves
+    a popcount per word. Threads keep their own tally and merge them through the
+    `tally` OpenMP reduction */
+    struct Tally {
+        long long population = 0;
+        long long changes = 0; // cells that were born or died
+        long long min_row = std::numeric_limits<long long>::max();
+        long long max_row = std::numeric_limits<long long>::min();
+        long long min_col = std::numeric_limits<long long>::max();
+        long long max_col = std::numeric_limits<long long>::min();
+
+        void merge(const Tally& o) {
+            population += o.population;
+            changes += o.changes;
+            min_row = std::min(min_row, o.min_row);
+            max_row = std::max(max_row, o.max_row);
+            min_col = std::min(min_col, o.min_col);
+            max_col = std::max(max_col, o.max_col);
+        }
+
+        // Living cells of one row span the columns [first, last]
+        void span(long long row, long long first, long long last) {
+            min_row = std::min(min_row, row);
+            max_row = std::max(max_row, row);
+            min_col = std::min(min_col, first);
+            max_col = std::max(max_col, last);
+        }
+
+        /* n words of one row, bit b of word k is column col+64k+b. before is the same
+        row one generation earlier. Uses the popcnt instruction where the CPU has it */
+        void words(long long row, long long col, const uint64_t* now, const uint64_t* before, int n);
+
+        // n rows of one word each starting at row, bit b of word k is column col+b of row+k
+        void rows(long long row, long long col, const uint64_t* now, const uint64_t* before, int n);
+
+        // Stats of the counted generation, births and deaths stay -1 if before_population is
+        Stats result(long long before_population) const;
+    };
+}
+
+#pragma omp declare reduction(tally : census::Tally : omp_out.merge(omp_in))
+
+#endif
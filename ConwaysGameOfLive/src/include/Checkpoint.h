@@ -0,0 +1,67 @@
+#ifndef CHECKPOINT_H
+#define CHECKPOINT_H
+#include <string>
+#include <thread>
+#include <mutex>
+#include <chrono>
+#include <condition_variable>
+
+#include "Engine.h"
+#include "Snapshot.h"
+
+class Checkpointer {
+    /* Periodic checkpoints of a running world, every so many generations and/or
+    seconds. capture packs the cells into a spare Snapshot on the simulating thread,
+    one pass over the grid, and hands it to a writer thread which compresses and writes
+    it while the world keeps evolving. The file is replaced by a rename, so a crash
+    leaves the previous checkpoint whole */
+    private:
+
+        std::string path;
+        long long every_generations;
+        double every_seconds;
+
+        long long last_generation;
+        std::chrono::steady_clock::time_point last_time;
+
+        // spare is owned by the writer while busy is set
+        Snapshot spare;
+        bool busy = false;
+        bool stop = false;
+        long long written = -1;
+        std::string failure;
+
+        std::mutex mutex;
+        std::condition_variable wake;
+        std::thread writer;
+
+        void write_loop();
+
+    public:
+
+        // 0 generations or seconds leaves that trigger out
+        Checkpointer(const std::string& path, long long generations, double seconds, long long generation);
+
+        // Waits for the last checkpoint to be written
+        ~Checkpointer();
+
+        // True once a checkpoint is due at this generation
+        bool due(long long generation);
+
+        // Generations the world may advance without checking, 1 for time based checkpoints
+        long long until_due(long long generation);
+
+        /* Captures world if the writer is idle and returns true, otherwise the world goes
+        on and the checkpoint stays due for the next generation */
+        bool capture(Engine& world, long long generation, const Rule& rule, bool torus);
+
+        // Generation of the last checkpoint on disk, -1 if none yet
+        long long last_written();
+
+        // Message of the last failed write, empty if none, cleared by reading it
+        std::string error();
+
+        const std::string& file() const { return path; }
+};
+
+#endif
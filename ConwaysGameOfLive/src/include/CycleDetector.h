@@ -0,0 +1,39 @@
+#ifndef CYCLEDETECTOR_H
+#define CYCLEDETECTOR_H
+#include <cstdint>
+#include <cstddef>
+#include <vector>
+#include <unordered_map>
+
+class CycleDetector {
+    /* Remembers the hashes of the last generations in a ring buffer and an index
+    from hash to generation. A hash seen again means the world has entered a cycle,
+    period 1 is a still life, longer periods are oscillators or spaceship loops */
+    private:
+
+        size_t capacity;
+        std::vector<uint64_t> ring;
+        std::unordered_map<uint64_t, long long> seen; // hash -> generation
+        long long first = 0; // generation of ring[first % capacity]
+        long long last = -1;
+
+        long long cycle_start = -1;
+        long long cycle_period = 0;
+
+    public:
+
+        CycleDetector(size_t capacity = 4096);
+
+        // Forget all generations, e.g. after the world was edited
+        void reset();
+
+        // Record the hash of a generation, returns true once a cycle is found
+        bool push(uint64_t hash, long long generation);
+
+        // Generation at which the cycle started, -1 if none was found
+        long long start();
+
+        long long period();
+};
+
+#endif
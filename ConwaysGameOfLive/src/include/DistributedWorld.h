@@ -0,0 +1,189 @@
+#ifndef DISTRIBUTEDWORLD_H
+#define DISTRIBUTEDWORLD_H
+#include <cstdint>
+#include <cstddef>
+#include <vector>
+
+#include "Engine.h"
+#ifdef HAVE_MPI
+#include <mpi.h>
+#endif
+
+namespace distributed {
+    /* Joins the processes started by mpirun for the lifetime of main. Rank 0 runs
+    the program as usual, the other ranks call serve() and run the collective part of
+    every distributed world rank 0 creates until rank 0 ends the session. Without MPI,
+    or started without mpirun, there is only rank 0 */
+    class Session {
+        private:
+
+            bool root = true;
+
+        public:
+
+            Session(int& argc, char**& argv);
+            ~Session();
+
+            bool is_root() const { return root; }
+
+            // Serves rank 0 until its session ends, only on the other ranks
+            void serve();
+    };
+}
+
+#ifdef HAVE_MPI
+class DistributedWorld : public Engine {
+    /* The grid cut into a 2D grid of blocks, one per MPI process, each stored as one
+    byte per cell with a one cell halo. Rank 0 holds the engine the CLI talks to: every
+    call is broadcast as a Command and then run by all ranks together on their own
+    block, so a generation costs one message from rank 0 however many are advanced.
+
+    evolve posts non-blocking receives for the 8 halo pieces and sends of the matching
+    edges, evolves the interior that needs no halo meanwhile and the rim once the
+    halos arrived. Edge columns are sent in place through vector datatypes. get, and
+    print and save through it, gather one band of bit-packed rows at a time to rank 0,
+    so rank 0 never holds more than a band of the grid however large it is */
+    private:
+
+        struct Command {
+            int32_t op;
+            int32_t id;
+            int64_t a;
+            int64_t b;
+            double p;
+        };
+
+        enum Op { CREATE, DESTROY, ADVANCE, SET, RANDOM, RULE, TORUS, STATS, HASH, MEMORY, GATHER, EXIT };
+
+        // Per local row counts of one generation, filled piece by piece by the kernel
+        struct RowCount {
+            uint32_t old_sum;
+            uint32_t new_sum;
+            int first;
+            int last;
+        };
+
+        int id;
+        int height;
+        int width;
+        bool torus = false;
+        Rule rule;
+
+        MPI_Comm grid = MPI_COMM_NULL;
+        int dims[2] = {1, 1};
+        int coords[2] = {0, 0};
+
+        // The local block is rows x cols cells, local cell (i, j) is global (row0 + i, col0 + j)
+        int row0 = 0;
+        int col0 = 0;
+        int rows = 0;
+        int cols = 0;
+        size_t stride = 0;
+
+        std::vector<uint8_t> state1;
+        std::vector<uint8_t> state2;
+
+        // Rank and halo datatype per direction 3 * (dr + 1) + (dc + 1), 4 is the block itself
+        int neighbour[9];
+        MPI_Datatype edge[9];
+
+        /* Hashed like World: every local row is a segment keyed by the sum of column
+        weights of its living cells, the process column is the segment block */
+        std::vector<uint32_t> col_weight;
+        std::vector<RowCount> row_counts;
+        uint64_t state_hash = 0;
+
+        // Population, births, deaths and global bounding box of the local block
+        Stats local;
+        bool local_valid = false;
+
+        /* Rows band_first to band_first + band_rows - 1 gathered on rank 0 for get, packed
+        as by Engine::pack. band_rows is 0 once cells changed */
+        std::vector<uint64_t> band;
+        int band_first = 1;
+        int band_rows = 0;
+
+        int words() const { return (width + 63) / 64; }
+
+        // Rows per band, about 8 MiB of packed rows
+        int band_height() const;
+
+        // Reduced answer of the last HASH or MEMORY command on rank 0
+        uint64_t result = 0;
+
+        // Rank 0 side, broadcasts the command and runs it here
+        void command(int op, int64_t a = 0, int64_t b = 0, double p = 0);
+
+        // Runs a broadcast command on every rank
+        void execute(const Command& c);
+
+        explicit DistributedWorld(const Command& create);
+
+        // Collective setup of the process grid for the current topology
+        void connect();
+
+        void disconnect();
+
+        uint8_t& cell(int i, int j) { return state1[size_t(i) * stride + j]; }
+
+        void recount();
+
+        template <class R>
+        void evolve_rect(int i0, int i1, int c0, int c1, const R& r, long long& births, long long& deaths);
+
+        template <class R>
+        void step(const R& r);
+
+        void advance_local(int generations);
+
+        Stats reduce_stats();
+
+        // Gathers rows first to first + n - 1 into band, collective
+        void gather(int first, int n);
+
+        // The band holding row x, gathered if it is not the current one
+        const uint64_t* band_row(int x);
+
+        friend class distributed::Session;
+
+    public:
+
+        DistributedWorld(int height, int width);
+        ~DistributedWorld();
+
+        const char* name() override { return "distributed"; }
+
+        int get_height() override;
+
+        int get_width() override;
+
+        void evolve() override;
+
+        void advance(int generations) override;
+
+        void set_rule(const Rule& rule) override;
+
+        void set_torus(bool torus) override;
+
+        uint64_t hash() override;
+
+        Stats stats() override;
+
+        // Bytes held by all ranks together
+        size_t memory() override;
+
+        void random(double probability = 0.3) override;
+
+        // Gathers band after band straight into rows
+        void pack(uint64_t* rows) override;
+
+        using Engine::set;
+        using Engine::get;
+
+        void set(int x, int y) override;
+
+        int get(int x, int y) override;
+};
+#endif
+
+#endif
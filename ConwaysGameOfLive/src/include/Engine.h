@@ -0,0 +1,106 @@
+#ifndef ENGINE_H
+#define ENGINE_H
+#include <string>
+#include <cstdint>
+#include <cstddef>
+
+#include "Rule.h"
+
+// Counters of one generation, births and deaths count against the generation before
+struct Stats {
+    long long population = 0;
+    long long births = -1; // -1 if not known, e.g. after cells were edited
+    long long deaths = -1;
+    // bounding box of the living cells, 1-based and inclusive, min > max if there are none
+    long long min_row = 1;
+    long long min_col = 1;
+    long long max_row = 0;
+    long long max_col = 0;
+
+    long long box_height() const { return max_row >= min_row ? max_row - min_row + 1 : 0; }
+    long long box_width() const { return max_col >= min_col ? max_col - min_col + 1 : 0; }
+};
+
+class Engine {
+    /* Common interface of all world engines. Coordinates are 1-based: (1, 1) is the
+    upper left cell and (height, width) the lower right one */
+    protected:
+
+        // Kept by engines that count inside evolve, edits have to clear counted_valid
+        Stats counted;
+        bool counted_valid = false;
+
+    public:
+
+        virtual ~Engine() {}
+
+        // Short name used by the CLI to select the engine
+        virtual const char* name() = 0;
+
+        virtual int get_height() = 0;
+
+        virtual int get_width() = 0;
+
+        int world_size();
+
+        virtual void evolve() = 0;
+
+        // Evolves several generations, engines that can block generations in cache override it
+        virtual void advance(int generations);
+
+        // Switches to a Life-like rule, the default only accepts B3/S23 and throws std::runtime_error otherwise
+        virtual void set_rule(const Rule& rule);
+
+        /* Wraps the edges around to a torus or keeps the plane bounded by dead cells,
+        the default only runs bounded and throws std::runtime_error for a torus */
+        virtual void set_torus(bool torus);
+
+        /* 64-bit hash of the current generation, equal generations of one engine give
+        equal hashes. Engines keep it up to date inside evolve, the default scans all cells */
+        virtual uint64_t hash();
+
+        /* Population, births, deaths and bounding box of the current generation. Engines
+        count them inside evolve, the default and edited worlds scan all cells */
+        virtual Stats stats();
+
+        // Bytes held for the cells and their bookkeeping, reported by the benchmark
+        virtual size_t memory() = 0;
+
+        // Draws the world on the terminal, zoomed out to fit if it is larger
+        virtual void print();
+
+        // Writes the inner grid in the text format read by World(std::string f_path)
+        virtual void save(std::string f_path);
+
+        /* Packs the living cells into height rows of (width + 63) / 64 words, bit b of
+        word k is column 64k+b+1. The default reads every cell through get */
+        virtual void pack(uint64_t* rows);
+
+        // Sets the living cells of rows packed as by pack, on an empty engine of the same size
+        virtual void unpack(const uint64_t* rows);
+
+        // Generates grid with random 0 1 occurences
+        virtual void random(double probability = 0.3) = 0;
+
+        virtual void set(int x, int y) = 0;
+
+        virtual void set(int index);
+
+        // Sets n cells of row x from column y on, clipped to the world. The default sets them one by one
+        virtual void set_run(int x, int y, int n);
+
+        virtual int get(int x, int y) = 0;
+
+        virtual int get(int index);
+};
+
+// Creates an empty engine by name, throws std::runtime_error for unknown names
+Engine* make_engine(const std::string& name, int height, int width);
+
+// Throws the error make_engine would for a name it cannot build, without building anything
+void check_engine_name(const std::string& name);
+
+// Copies all living cells of one engine into another one of at least the same size
+void copy_cells(Engine& from, Engine& to);
+
+#endif
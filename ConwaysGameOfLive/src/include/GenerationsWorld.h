@@ -0,0 +1,66 @@
+#ifndef GENERATIONSWORLD_H
+#define GENERATIONSWORLD_H
+#include <cstdint>
+#include <cstddef>
+#include <string>
+
+#include "ByteWorld.h"
+#include "Rule.h"
+
+namespace genlife {
+    /* Transition tables of a rule, indexed by the number of living neighbours:
+    born[n] is the next state of a dead cell, kept[n] the one of a living cell,
+    1 if it survives and else 2 (or 0 for two state rules). Cells in a dying
+    state count up to states and then die, whatever their neighbours */
+    struct Transitions {
+        uint8_t born[16];
+        uint8_t kept[16];
+        uint8_t states;
+
+        explicit Transitions(const Rule& rule);
+    };
+
+    /* Compute rows 1..height of out from in, laid out as in ByteWorld, return the
+    hash of out and count its state 1 cells into tally. The AVX2 kernel looks the
+    tables up with one byte shuffle per 32 cells, the SSE one selects from them with
+    comparisons */
+    uint64_t evolve_avx2(const uint8_t* in, uint8_t* out, int height, int width, size_t stride, const Transitions& t, census::Tally& tally);
+
+    uint64_t evolve_sse(const uint8_t* in, uint8_t* out, int height, int width, size_t stride, const Transitions& t, census::Tally& tally);
+}
+
+class GenerationsWorld : public ByteWorld {
+    /* Multi-state engine for Generations rules such as Brian's Brain (B2/S/C3) on the
+    byte grid of ByteWorld, every byte holding the state of its cell. get returns the
+    state, set makes a cell alive (state 1) */
+    private:
+
+        Rule rule;
+        genlife::Transitions transitions;
+
+    public:
+
+        GenerationsWorld();
+        GenerationsWorld(int height, int width);
+
+        // Reads the text format written by save, with states instead of 0/1
+        GenerationsWorld(std::string f_path);
+
+        const char* name() override { return "generations"; }
+
+        void evolve() override;
+
+        // Accepts any rule, cells in states the rule does not have die
+        void set_rule(const Rule& rule) override;
+
+        // Living cells green, dying ones fading from yellow to dark red
+        void print() override;
+
+        // Height, width and the rows of states, the text format of World for two state rules
+        void save(std::string f_path) override;
+
+        // Sets cell (x, y) to state, states past the rule are ignored
+        void set_state(int x, int y, int state);
+};
+
+#endif
@@ -0,0 +1,42 @@
+#ifndef HASH_H
+#define HASH_H
+#include <cstdint>
+
+namespace hashing {
+    // splitmix64 finalizer, spreads every input bit over the whole word
+    inline uint64_t mix64(uint64_t x) {
+        x ^= x >> 30;
+        x *= 0xBF58476D1CE4E5B9ULL;
+        x ^= x >> 27;
+        x *= 0x94D049BB133111EBULL;
+        x ^= x >> 31;
+        return x;
+    }
+
+    // Key of a living cell, a generation hashes to the xor of the keys of its cells
+    inline uint64_t cell(int64_t x, int64_t y) {
+        return mix64((uint64_t(x) << 32) ^ uint64_t(uint32_t(y)) ^ 0x9E3779B97F4A7C15ULL);
+    }
+
+    // Key of a nonzero word of packed cells at position index
+    inline uint64_t word(uint64_t index, uint64_t bits) {
+        return mix64(bits ^ mix64(index + 0x9E3779B97F4A7C15ULL));
+    }
+
+    // Order dependent fold over the words of a row, one multiply per word
+    inline uint64_t fold(uint64_t acc, uint64_t bits) {
+        return (acc + bits) * 0x9E3779B97F4A7C15ULL;
+    }
+
+    // Key of a folded row, empty rows fold to 0 and contribute nothing
+    inline uint64_t row(uint64_t index, uint64_t acc) {
+        return acc == 0 ? 0 : mix64(acc ^ mix64(index));
+    }
+
+    // Key of a row segment given the sum of the column weights of its living cells
+    inline uint64_t segment(int64_t row, int64_t block, uint32_t sum) {
+        return sum == 0 ? 0 : mix64(((uint64_t(sum) << 32) | uint32_t(row)) ^ mix64(uint64_t(block)));
+    }
+}
+
+#endif
@@ -0,0 +1,118 @@
+#ifndef HASHLIFE_H
+#define HASHLIFE_H
+#include <cstdint>
+#include <vector>
+#include <unordered_map>
+
+#include "Engine.h"
+
+class HashLife : public Engine {
+    /* HashLife on an unbounded plane. The universe is a quadtree of canonical nodes,
+    equal subtrees are stored once, and every node of level k memoizes its RESULT: the
+    centre node of level k-1 advanced by 2^(k-2) generations, or by the current step
+    2^step_exp when that is smaller. Nodes live in one pool and are found through a
+    hash table of chains. The pool is bounded by max_nodes: once it is full, everything
+    not reachable from the root, the empty nodes or the held stack is collected, also in
+    the middle of a step. Every result() call holds its node and the results it is still
+    combining on that stack until it returns. A collection that frees less than a
+    quarter of the pool throws, since the pattern needs about as many nodes as allowed.
+
+    height and width only describe the window seen through get/set/print, (1, 1) is
+    plane cell (0, 0). Cells outside the window keep evolving */
+    private:
+
+        struct Node {
+            uint32_t nw, ne, sw, se; // children, level 1 nodes point to the leaves 0 and 1
+            uint32_t result;         // memoized RESULT or none
+            uint32_t next;           // next node in the same hash chain
+            uint64_t population;
+            uint64_t hash;           // structural hash, equal subtrees hash equally
+            uint8_t level;
+        };
+
+        static const uint32_t none = 0xffffffff;
+
+        int height;
+        int width;
+
+        std::vector<Node> nodes;      // ids 0 and 1 are the dead and the living cell
+        std::vector<uint32_t> buckets;
+        std::vector<uint32_t> free_ids;
+        std::vector<uint32_t> empties; // canonical empty node per level
+        std::vector<uint32_t> held;    // nodes the recursion of result() still needs
+        size_t max_nodes;
+        size_t gc_runs = 0;
+
+        uint32_t root;
+        int step_exp = -1; // results are memoized for steps of 2^step_exp
+
+        uint32_t join(uint32_t nw, uint32_t ne, uint32_t sw, uint32_t se);
+        uint32_t empty(int level);
+        uint32_t centre(uint32_t n);
+        uint32_t expand(uint32_t n);
+        uint32_t base_result(uint32_t n);
+        uint32_t result(uint32_t n);
+        uint32_t set_cell(uint32_t n, int64_t row, int64_t col);
+        int get_cell(uint32_t n, int64_t row, int64_t col);
+
+        // Distance of the nearest living cell of n from its north, south, west or east
+        // edge (side 0 to 3), memo holds the distances of the nodes already seen
+        int64_t edge(uint32_t n, int side, std::unordered_map<uint32_t, int64_t>& memo);
+
+        // Grow the root until plane cell (row, col) lies inside it
+        void cover(int64_t row, int64_t col);
+
+        // Drop empty borders so equal patterns get the same root
+        void shrink();
+
+        void rehash(size_t n_buckets);
+        void collect();
+
+        // Collects if the pool is full, throws std::runtime_error if that frees too little
+        void reclaim();
+
+        // Advance by 2^exp generations
+        void step_pow2(int exp);
+
+    public:
+
+        HashLife();
+        // The pool holds at most max_nodes nodes plus the few one result() call joins, see above
+        HashLife(int height, int width, size_t max_nodes = size_t(1) << 22);
+
+        const char* name() override { return "hashlife"; }
+
+        int get_height() override;
+
+        int get_width() override;
+
+        void evolve() override;
+
+        uint64_t hash() override;
+
+        /* Population from the root node, the box by descending into non-empty nodes along
+        its edges. Births and deaths are not known as generations are skipped in jumps */
+        Stats stats() override;
+
+        size_t memory() override;
+
+        void random(double probability = 0.3) override;
+
+        using Engine::set;
+        using Engine::get;
+
+        void set(int x, int y) override;
+
+        int get(int x, int y) override;
+
+        // Advance by any number of generations, one power of two per set bit
+        void jump(uint64_t generations);
+
+        uint64_t population();
+
+        size_t node_count();
+
+        size_t collections();
+};
+
+#endif
@@ -0,0 +1,70 @@
+#ifndef HISTORY_H
+#define HISTORY_H
+#include <deque>
+#include <vector>
+#include <cstdint>
+
+#include "Engine.h"
+
+class History {
+    /* Past generations of a run, bit-packed as by Engine::pack. Every interval-th
+    generation is kept as a keyframe, the ones in between as the XOR with the generation
+    before, which is zero wherever nothing changed. Both are run-length encoded like the
+    rle snapshots, so a still life costs a few words per generation. Once the entries
+    outgrow the budget the oldest keyframe is dropped together with its deltas */
+    private:
+
+        struct Entry {
+            long long generation;
+            bool key;
+            bool raw; // data is not encoded because encoding did not make it smaller
+            std::vector<uint64_t> data;
+        };
+
+        size_t budget;
+        long long interval;
+        std::deque<Entry> entries;
+        size_t bytes = 0;
+        size_t keys = 0;
+
+        int height = 0;
+        int width = 0;
+        // the generation recorded last, unpacked, and its number or -1
+        std::vector<uint64_t> previous;
+        long long previous_generation = -1;
+        long long key_generation = -1;
+        std::vector<uint64_t> current;
+        std::vector<uint64_t> scratch;
+
+        // Unpacks the words of an entry, all height rows of them
+        void decode(const Entry& entry, std::vector<uint64_t>& words) const;
+
+        // Forgets the generations from generation on
+        void truncate(long long generation);
+
+    public:
+
+        // budget in bytes for the encoded generations, a keyframe every interval generations
+        History(size_t budget, long long interval);
+
+        /* Records the current generation of world. A generation recorded before, e.g.
+        after a rewind or an edit, replaces it and everything after it; a gap or a new
+        world size starts with a keyframe */
+        void record(Engine& world, long long generation);
+
+        // True if generation can be rebuilt
+        bool has(long long generation) const;
+
+        long long first() const { return entries.empty() ? -1 : entries.front().generation; }
+        long long last() const { return entries.empty() ? -1 : entries.back().generation; }
+
+        /* Sets the living cells of generation on world, an empty engine of the recorded
+        size, by decoding the nearest keyframe before it and applying the deltas up to it.
+        Throws std::runtime_error for an engine of another size */
+        void restore(long long generation, Engine& world);
+
+        size_t memory() const { return bytes; }
+        size_t keyframes() const { return keys; }
+};
+
+#endif
@@ -0,0 +1,102 @@
+#ifndef MAPPEDWORLD_H
+#define MAPPEDWORLD_H
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "Engine.h"
+#include "Snapshot.h"
+
+class MappedWorld : public Engine {
+    /* Out-of-core world: both generations live bit-packed in a memory-mapped file, so
+    the grid may be larger than RAM and the OS pages it in and out. The file is a raw
+    snapshot whose header flags which of the two sets of rows is current, so every other
+    engine can load it and it is a checkpoint of the last generation at all times.
+    evolve walks the rows in stripes of a few MiB front to back: the mapping is read
+    sequentially, the next stripe is prefetched while one is computed and the stripes
+    written are handed to writeback as soon as they are done */
+    private:
+
+        int height;
+        int width;
+        int words; // words per row, no border
+        uint64_t last_mask; // valid bits of the last word of a row
+        int stripe; // rows per stripe
+        std::vector<uint64_t> zeros; // the dead rows above the first and below the last
+
+        std::string path;
+        int fd = -1;
+        void* map = nullptr;
+        size_t size = 0;
+        SnapshotHeader* head = nullptr;
+
+        uint64_t state_hash = 0;
+
+        MappedWorld(const MappedWorld&) = delete;
+        MappedWorld& operator=(const MappedWorld&) = delete;
+
+        // Maps size bytes of the open file and sets up the stripes
+        void attach();
+
+        // Rows of the current and of the next generation
+        uint64_t* current();
+        uint64_t* next();
+
+        uint64_t row_hash(int i);
+
+        void rehash();
+
+        // Prefetches rows [first, last] of rows, clipped to the world
+        void prefetch(const uint64_t* rows, long long first, long long last);
+
+        // Starts writing rows [first, last] of rows back to the file
+        void write_back(const uint64_t* rows, int first, int last);
+
+    public:
+
+        // File used by make_engine, relative to the working directory
+        static std::string default_path;
+
+        // Creates path, replacing an older file by a rename so a world still mapped from it stays valid
+        MappedWorld(const std::string& path, int height, int width);
+
+        // Opens a raw snapshot in place and goes on from its generation, throws std::runtime_error otherwise
+        explicit MappedWorld(const std::string& path);
+
+        ~MappedWorld();
+
+        const char* name() override { return "mapped"; }
+
+        int get_height() override;
+
+        int get_width() override;
+
+        void evolve() override;
+
+        uint64_t hash() override;
+
+        // Bytes of the file, most of them are pages the OS may evict
+        size_t memory() override;
+
+        void random(double probability = 0.3) override;
+
+        void pack(uint64_t* rows) override;
+
+        void unpack(const uint64_t* rows) override;
+
+        using Engine::set;
+        using Engine::get;
+
+        void set(int x, int y) override;
+
+        int get(int x, int y) override;
+
+        // Writes generation, rule and topology into the header, evolve counts the generation on
+        void describe(long long generation, const Rule& rule, bool torus);
+
+        long long generation() const { return head->generation; }
+
+        const std::string& file() const { return path; }
+};
+
+#endif
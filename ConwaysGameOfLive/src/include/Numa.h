@@ -0,0 +1,41 @@
+#ifndef NUMA_H
+#define NUMA_H
+#include <vector>
+
+namespace numa {
+    /* Thread placement for the parallel engines. The kernels hand every OpenMP thread
+    the same band of rows each generation, and Linux puts a page on the node of the
+    thread that touches it first, so a band that is allocated by its own thread stays
+    local as long as the thread does not move. pin_threads keeps it from moving: thread
+    t of a team runs on the t-th allowed CPU in node order, so a team smaller than the
+    machine fills one socket before the next. Without /sys/devices/system/node the
+    machine counts as a single node */
+
+    // Nodes of the machine, at least 1
+    int nodes();
+
+    // Node of a CPU, 0 if unknown
+    int node_of(int cpu);
+
+    // CPUs the process was allowed to run on at start, ordered by node and then number
+    const std::vector<int>& cpus();
+
+    /* Pins thread t of every OpenMP team of the current size to cpus()[t % cpus().size()].
+    The calling thread is thread 0 and stays on cpus()[0] afterwards. Returns false where threads cannot be pinned, e.g. without OpenMP or outside Linux */
+    bool pin_threads();
+
+    // Lets every thread run on all of cpus() again
+    void unpin_threads();
+
+    /* Lets the calling thread run on all of cpus(). The master of the OpenMP team is
+    pinned like the others, and threads it starts inherit its single CPU, so threads
+    outside the kernels' teams call this first to stay off the CPU of thread 0 */
+    void unpin_this_thread();
+
+    bool pinned();
+
+    // Threads of an OpenMP team of the current size on every node, sampled where they run now
+    std::vector<int> team_nodes();
+}
+
+#endif
@@ -0,0 +1,67 @@
+#ifndef PACKEDWORLD_H
+#define PACKEDWORLD_H
+#include <cstdint>
+#include <vector>
+
+#include "Engine.h"
+
+class PackedWorld : public Engine {
+    /* Bit-packed world: 64 cells per word in one contiguous buffer. Bit b of word k
+    in a row holds column 64*k+b+1. Every row has a zero word on either side and the
+    grid a zero row above and below, so the kernel runs without edge cases */
+    protected:
+
+        int height;
+        int width;
+        int words;  // payload words per row
+        int stride; // words per row including the two border words
+        uint64_t last_mask; // valid bits of the last payload word
+
+        std::vector<uint64_t> state1;
+        std::vector<uint64_t> state2;
+
+        // xor of the hashing::row keys of state1, kept by evolve
+        uint64_t state_hash = 0;
+
+        uint64_t row_hash(const std::vector<uint64_t>& state, int i);
+
+        void rehash();
+
+        uint64_t* cell_word(std::vector<uint64_t>& state, int x, int y);
+
+    public:
+
+        PackedWorld();
+        PackedWorld(int height, int width);
+
+        const char* name() override { return "packed"; }
+
+        int get_height() override;
+
+        int get_width() override;
+
+        void evolve() override;
+
+        uint64_t hash() override;
+
+        size_t memory() override;
+
+        void random(double probability = 0.3) override;
+
+        // The rows are copied word by word, the layout is the same
+        void pack(uint64_t* rows) override;
+
+        void unpack(const uint64_t* rows) override;
+
+        using Engine::set;
+        using Engine::get;
+
+        void set(int x, int y) override;
+
+        // Sets the bits word by word and hashes the row once
+        void set_run(int x, int y, int n) override;
+
+        int get(int x, int y) override;
+};
+
+#endif
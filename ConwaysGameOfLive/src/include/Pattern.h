@@ -0,0 +1,29 @@
+#ifndef PATTERN_H
+#define PATTERN_H
+#include <string>
+#include <istream>
+#include <ostream>
+
+#include "Engine.h"
+
+namespace pattern {
+    /* Golly RLE and plaintext (.cells) patterns. The readers parse a buffered stream
+    in one pass and hand every run of living cells to Engine::set_run as soon as it is
+    complete, so no dense copy of the pattern is built. Cell (0, 0) of the pattern is
+    placed at (x, y), cells outside the world are dropped */
+
+    // Reads RLE, sets rule from the header (B3/S23 if it has none) and returns the living cells read
+    long long read_rle(std::istream& in, Engine& world, int x, int y, Rule& rule);
+
+    long long read_cells(std::istream& in, Engine& world, int x, int y);
+
+    // Writes the bounding box of the living cells as RLE lines of at most 70 characters
+    void write_rle(std::ostream& out, Engine& world, const Rule& rule);
+
+    void write_cells(std::ostream& out, Engine& world);
+
+    // "rle" or "cells" by the extension of path, empty for other files
+    std::string format_of(const std::string& path);
+}
+
+#endif
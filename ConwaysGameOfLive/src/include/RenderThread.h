@@ -0,0 +1,82 @@
+#ifndef RENDER_THREAD_H
+#define RENDER_THREAD_H
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <vector>
+#include <cstdint>
+
+#include "Engine.h"
+#include "Renderer.h"
+
+struct Frame {
+    // One generation's living cells packed as by Engine::pack
+    long long generation = 0;
+    int height = 0;
+    int width = 0;
+    std::vector<uint64_t> rows;
+};
+
+class FrameRing {
+    /* Lock-free ring of frames for one producer and one consumer. The producer writes
+    the slot at head and publishes it by advancing head, the consumer frees slots by
+    advancing tail, so each slot belongs to exactly one side at a time and the buffers
+    are reused without locking or allocating once they reached the world size */
+    private:
+
+        std::vector<Frame> slots;
+        std::atomic<size_t> head{0}; // advanced by the producer only
+        std::atomic<size_t> tail{0}; // advanced by the consumer only
+
+    public:
+
+        explicit FrameRing(size_t capacity);
+
+        // Packs world into the next free slot, false if the ring is full and the frame is dropped
+        bool publish(Engine& world, long long generation);
+
+        /* The newest published frame or nullptr, frees the older ones unseen. The frame
+        stays valid until release */
+        const Frame* latest(size_t& skipped);
+
+        void release();
+};
+
+class RenderThread {
+    /* Draws the frames of a run on a thread of its own at a target frame rate, so the
+    simulation never waits for the terminal. The simulation publishes a frame every
+    generation into a FrameRing; frames that find the ring full or that the renderer
+    is too slow to show are dropped */
+    private:
+
+        Renderer& renderer;
+        std::chrono::milliseconds interval;
+        FrameRing ring;
+        std::atomic<bool> stop{false};
+        long long drawn = 0;
+        long long skipped = 0;
+        std::atomic<long long> refused{0};
+        std::thread drawer;
+
+        void draw_loop();
+
+        // Draws the newest frame if there is one
+        void draw_latest();
+
+    public:
+
+        // renderer belongs to the thread until destruction, interval_ms is the time between frames
+        RenderThread(Renderer& renderer, int interval_ms);
+
+        // Joins the thread if finish was not called
+        ~RenderThread();
+
+        // Called by the simulation after every generation, never blocks
+        void publish(Engine& world, long long generation);
+
+        /* Joins the thread and reports the frames drawn and dropped, the renderer is free
+        again to draw the final generation */
+        void finish(long long& drawn, long long& dropped);
+};
+
+#endif
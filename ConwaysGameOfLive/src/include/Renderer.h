@@ -0,0 +1,59 @@
+#ifndef RENDERER_H
+#define RENDERER_H
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "Engine.h"
+
+class Renderer {
+    /* Draws worlds on an ANSI terminal. A frame is first reduced to one code per screen
+    cell, then only the cells whose code differs from what the terminal shows are written,
+    each run of them behind one cursor-addressing escape. The frame is built in a buffer
+    that keeps its capacity and goes out with a single write. Worlds larger than the
+    terminal are zoomed out: every screen cell covers k x k cells and shows how densely
+    they are populated */
+    private:
+
+        int zoom = 0; // cells per screen cell along each side, 0 picks the smallest that fits
+        int top = 1; // world cell in the top left screen cell
+        int left = 1;
+        int rows = 0; // screen cells of the frame on the terminal
+        int cols = 0;
+        int shown_zoom = 0;
+        std::vector<uint8_t> shown; // code of every screen cell on the terminal, empty after reset
+        std::vector<uint8_t> next;
+        std::vector<uint64_t> bits;
+        std::string out;
+
+        // Sizes the frame for a world and returns true if it has to be drawn in full
+        bool layout(int height, int width);
+
+        // Fills next with the codes of the screen cells from rows packed as by Engine::pack
+        void shade(const uint64_t* rows, int height, int width);
+
+        // Writes the screen cells of next that differ from shown, or all of them if full
+        void emit(bool full);
+
+        // Appends the cursor-addressing escape for screen cell (row, col), 0-based
+        void move(int row, int col);
+
+    public:
+
+        // k cells per screen cell, 0 for the smallest zoom showing the world from (top, left) on
+        void set_zoom(int k, int top = 1, int left = 1);
+
+        // The next frame clears the screen and draws every cell
+        void reset();
+
+        // Draws the current generation, reading states through get if the rule has more than 2
+        void draw(Engine& world, int states = 2);
+
+        // Draws living cells packed as by Engine::pack, e.g. a frame captured by another thread
+        void draw(const uint64_t* rows, int height, int width);
+
+        // Rows and columns of the terminal on standard output, 0 if it is not a terminal
+        static void terminal_size(int& rows, int& cols);
+};
+
+#endif
@@ -0,0 +1,84 @@
+#ifndef RULE_H
+#define RULE_H
+#include <cstdint>
+#include <string>
+
+struct Rule {
+    /* Life-like rule in B/S notation: bit n of birth is set if a dead cell with n
+    living neighbours is born, bit n of survive if a living one stays alive.
+    Generations rules have more than 2 states: a living cell (state 1) that does
+    not survive decays through the states 2..states-1 one per generation before
+    it is dead (state 0), and only living cells count as neighbours */
+    uint32_t birth = 1 << 3;
+    uint32_t survive = (1 << 2) | (1 << 3);
+    int states = 2;
+
+    Rule() {}
+    Rule(uint32_t birth, uint32_t survive, int states = 2): birth(birth), survive(survive), states(states) {}
+
+    /* Parses "B36/S23" (either order, any case), Generations rules as "B2/S/C3" or
+    "S/B/C" digits such as "345/2/4", or one of the names life, highlife, daynight,
+    seeds, brianbrain and starwars. Throws std::runtime_error for malformed rules
+    and for B0 rules, which would bring the dead border outside the world to life */
+    static Rule parse(const std::string& text);
+
+    // Canonical notation, e.g. "B3/S23" or "B2/S/C3"
+    std::string str() const;
+
+    // Conway's B3/S23
+    bool is_life() const { return *this == Rule(); }
+
+    bool operator==(const Rule& other) const {
+        return birth == other.birth && survive == other.survive && states == other.states;
+    }
+    bool operator!=(const Rule& other) const { return !(*this == other); }
+};
+
+/* Rule policies for the templated kernels, next(n_sum, alive) returns the next state
+of a cell as 0 or 1. Both only compare n_sum with constants, so loops over int cells
+stay branch-free and vectorize */
+
+// Masks fixed at compile time, only the comparisons for set bits remain
+template <uint32_t Birth, uint32_t Survive>
+struct FixedRule {
+    template <uint32_t Mask, int N = 0>
+    struct Matches {
+        static inline int of(int n_sum) {
+            return (((Mask >> N) & 1) ? int(n_sum == N) : 0) | Matches<Mask, N + 1>::of(n_sum);
+        }
+    };
+
+    template <uint32_t Mask>
+    struct Matches<Mask, 9> {
+        static inline int of(int) { return 0; }
+    };
+
+    inline int next(int n_sum, int alive) const {
+        return (Matches<Birth>::of(n_sum) & (alive ^ 1)) | (Matches<Survive>::of(n_sum) & alive);
+    }
+};
+
+// Any rule chosen at run time, 9 comparisons against per count flags
+struct AnyRule {
+    int born[9];
+    int stays[9];
+
+    explicit AnyRule(const Rule& rule) {
+        for (int n = 0; n < 9; n++) {
+            born[n] = (rule.birth >> n) & 1;
+            stays[n] = (rule.survive >> n) & 1;
+        }
+    }
+
+    inline int next(int n_sum, int alive) const {
+        int b = 0;
+        int s = 0;
+        for (int n = 0; n < 9; n++) {
+            b |= int(n_sum == n) & born[n];
+            s |= int(n_sum == n) & stays[n];
+        }
+        return (b & (alive ^ 1)) | (s & alive);
+    }
+};
+
+#endif
@@ -0,0 +1,101 @@
+#ifndef SNAPSHOT_H
+#define SNAPSHOT_H
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "Engine.h"
+
+// First bytes of a snapshot file, followed by the rest of SnapshotHeader
+const char snapshot_magic[8] = {'L', 'I', 'F', 'E', 'S', 'N', 'A', 'P'};
+
+struct SnapshotHeader {
+    /* 64 bytes at the start of a snapshot file, little endian as written by x86.
+    payload bytes of rows follow: height rows of (width + 63) / 64 words, bit b of word
+    k is column 64k+b+1, either as they are or run-length encoded. The file of a mapped
+    world holds two sets of raw rows and flags the one that is current */
+    char magic[8];
+    uint32_t version;
+    uint32_t flags;
+    int64_t height;
+    int64_t width;
+    int64_t generation;
+    uint32_t birth;
+    uint32_t survive;
+    uint32_t states;
+    uint32_t torus;
+    uint64_t payload;
+
+    static const uint32_t current = 1;
+    static const uint32_t rle = 1; // flag: the words are run-length encoded
+    // flag: raw rows only, the current ones are a second set of payload bytes after the first
+    static const uint32_t swapped = 2;
+};
+
+static_assert(sizeof(SnapshotHeader) == 64, "the rows after the header have to stay 8 byte aligned");
+
+struct Snapshot {
+    /* The cells of one generation bit-packed in memory, together with what is needed
+    to go on from there: generation, rule and topology */
+    int height = 0;
+    int width = 0;
+    long long generation = 0;
+    Rule rule;
+    bool torus = false;
+    std::vector<uint64_t> rows;
+
+    int words() const { return (width + 63) / 64; }
+
+    /* Packs the current generation of world, reusing the memory of rows. Throws
+    std::runtime_error for rules with more than 2 states, whose decaying cells a bit
+    per cell would lose */
+    void capture(Engine& world, long long generation, const Rule& rule, bool torus);
+
+    // Writes path + ".tmp" and renames it over path, so path always holds a whole snapshot
+    void write(const std::string& path, bool compress) const;
+
+    // True if path starts with the snapshot magic
+    static bool is_snapshot(const std::string& path);
+};
+
+class SnapshotFile {
+    /* A snapshot file mapped read-only into memory. Raw rows go to Engine::unpack
+    straight from the mapping, so loading costs one copy from the page cache into the
+    engine's storage and nothing is parsed, run-length encoded rows are decoded first */
+    private:
+
+        int fd = -1;
+        void* map = nullptr;
+        size_t size = 0;
+        const SnapshotHeader* head = nullptr;
+
+        SnapshotFile(const SnapshotFile&) = delete;
+        SnapshotFile& operator=(const SnapshotFile&) = delete;
+
+    public:
+
+        // Throws std::runtime_error if path is not a readable snapshot
+        explicit SnapshotFile(const std::string& path);
+        ~SnapshotFile();
+
+        int height() const { return int(head->height); }
+        int width() const { return int(head->width); }
+        long long generation() const { return head->generation; }
+        Rule rule() const { return Rule(head->birth, head->survive, int(head->states)); }
+        bool torus() const { return head->torus != 0; }
+        bool compressed() const { return (head->flags & SnapshotHeader::rle) != 0; }
+
+        // Sets the living cells on an empty engine of the snapshot size
+        void restore(Engine& world) const;
+};
+
+namespace rle {
+    /* Runs of zero words are common in Life, so the stream is a sequence of records:
+    the number of zero words, the number of literal words and the literal words */
+    void encode(const std::vector<uint64_t>& words, std::vector<uint64_t>& out);
+
+    // Decodes into exactly n words, throws std::runtime_error on a broken stream
+    void decode(const uint64_t* in, size_t size, uint64_t* out, size_t n);
+}
+
+#endif
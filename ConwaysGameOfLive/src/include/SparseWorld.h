@@ -0,0 +1,84 @@
+#ifndef SPARSEWORLD_H
+#define SPARSEWORLD_H
+#include <cstdint>
+#include <vector>
+#include <unordered_map>
+
+#include "Engine.h"
+
+class SparseWorld : public Engine {
+    /* Unbounded plane made of 64x64 cell chunks, allocated on demand in a hash map
+    keyed by chunk coordinate and freed as soon as they are empty. A chunk holds one
+    bit-packed word per row for the current and the next generation, so memory grows
+    with the live area instead of the bounding box.
+
+    height and width only describe the window seen through get/set/print, (1, 1) is
+    plane cell (origin_row, origin_col) */
+    private:
+
+        struct Chunk {
+            uint64_t rows[2][64]; // [generation parity][row], bit b is column b
+        };
+
+        static const int size = 64;
+
+        int height;
+        int width;
+        int64_t origin_row = 0;
+        int64_t origin_col = 0;
+        int parity = 0; // rows[parity] is the current generation
+
+        std::unordered_map<uint64_t, Chunk> chunks;
+
+        // xor of the chunk hashes of the current generation, kept by evolve
+        uint64_t state_hash = 0;
+
+        static uint64_t chunk_hash(uint64_t key, const uint64_t* rows);
+
+        static uint64_t key(int64_t cy, int64_t cx);
+
+        // Chunk at chunk coordinate (cy, cx), created empty if create is set
+        Chunk* chunk(int64_t cy, int64_t cx, bool create);
+
+        void set_cell(int64_t row, int64_t col);
+
+        int get_cell(int64_t row, int64_t col);
+
+    public:
+
+        SparseWorld();
+        SparseWorld(int height, int width);
+
+        const char* name() override { return "sparse"; }
+
+        int get_height() override;
+
+        int get_width() override;
+
+        void evolve() override;
+
+        uint64_t hash() override;
+
+        // Counted over the whole plane, the box may reach outside the window
+        Stats stats() override;
+
+        size_t memory() override;
+
+        void random(double probability = 0.3) override;
+
+        using Engine::set;
+        using Engine::get;
+
+        void set(int x, int y) override;
+
+        int get(int x, int y) override;
+
+        // Move the window so that (1, 1) shows plane cell (row, col)
+        void view(int64_t row, int64_t col);
+
+        size_t chunk_count();
+
+        uint64_t population();
+};
+
+#endif
@@ -0,0 +1,40 @@
+#ifndef TABLEWORLD_H
+#define TABLEWORLD_H
+#include <cstdint>
+#include <vector>
+
+#include "PackedWorld.h"
+#include "Rule.h"
+
+class TableWorld : public PackedWorld {
+    /* Lookup table engine on the bit rows of PackedWorld. The 4x4 cells around every
+    2x2 block form a 16 bit index into a 65,536 entry table that holds the next state
+    of the block, so evolve does one lookup per 4 cells instead of summing neighbours.
+    Plain scalar code, the fast path for CPUs without AVX2. Any Life-like rule only
+    changes the table */
+    private:
+
+        std::vector<uint8_t> table;
+
+    public:
+
+        TableWorld();
+        TableWorld(int height, int width);
+
+        const char* name() override { return "table"; }
+
+        void evolve() override;
+
+        size_t memory() override;
+
+        void set_rule(const Rule& rule) override;
+};
+
+namespace tablelife {
+    /* Entry (a | b << 4 | c << 8 | d << 12) for the rows a..d of a 4x4 neighbourhood,
+    bit 0 of each row being its leftmost cell, holds the centre 2x2 cells of the next
+    generation under rule: bits 0, 1 the upper row and bits 2, 3 the lower one */
+    std::vector<uint8_t> build(const Rule& rule);
+}
+
+#endif
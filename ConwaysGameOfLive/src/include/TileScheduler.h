@@ -0,0 +1,46 @@
+#ifndef TILE_SCHEDULER_H
+#define TILE_SCHEDULER_H
+#include <atomic>
+#include <memory>
+#include <vector>
+#include <cstdint>
+
+class TileScheduler {
+    /* Work-stealing queues of tiles for one generation. Every thread gets a deque
+    holding the active tiles of its own band of rows, which place_rows allocated on its
+    node, and works through it front to back. A thread whose deque ran dry steals from
+    the back of the others, alternating between the next higher and lower thread
+    numbers, which pinning puts on the nearest CPUs, so a busy band is shared out from the
+    end its owner reaches last. All tiles are queued before the threads start and none
+    are added later, so a deque is just a range whose ends move towards each other,
+    both packed into one word that owner and thieves claim with a compare-and-swap */
+    private:
+
+        struct Deque {
+            std::atomic<uint64_t> range{0}; // first unclaimed tile in the high half, end in the low half
+            char pad[64 - sizeof(std::atomic<uint64_t>)]; // one cache line per deque
+        };
+
+        std::vector<int> tiles;
+        std::unique_ptr<Deque[]> deques; // atomics cannot live in a vector that resizes
+        int capacity = 0;
+        int threads = 0;
+
+        // Claims the front of deque k, -1 if it is empty
+        int pop(int k);
+
+        // Claims the back of deque k, -1 if it is empty
+        int steal(int k);
+
+    public:
+
+        /* Queues tiles for n threads, thread k owning tiles[first[k]] up to
+        tiles[first[k + 1]] exclusive. Must not overlap with next */
+        void fill(const std::vector<int>& tiles, const std::vector<int>& first, int n);
+
+        /* The next tile for thread k, its own or a stolen one, -1 once every deque is
+        empty. Thread numbers missing from the team are simply stolen from */
+        int next(int k, long long& stolen);
+};
+
+#endif
@@ -9,7 +9,10 @@
 #include <thread>
 #include <random>
 
-class World {
+#include "Engine.h"
+#include "TileScheduler.h"
+
+class World : public Engine {
     /* The array holds an additional border of 0 around to allow efficient checking 
     without edge cases*/
     private: 
@@ -19,40 +22,171 @@ class World {
 
         std::vector<std::vector<int>> state1;
         std::vector<std::vector<int>> state2; 
+
+        /* Active tile tracking: the grid is cut into tile_h x tile_w blocks and a block is
+        only evolved if it or one of its 8 neighbours changed in the last generation.
+        Skipped tiles hold the same cells in state1 and state2, so nothing needs to be
+        copied for them */
+        int tile_rows = 0; 
+        int tile_cols = 0; 
+        std::vector<unsigned char> active;  // tiles to evolve in the next generation
+        std::vector<unsigned char> changed; // written by the thread owning the tile
+        std::vector<int> active_list;       // the dirty set as tile indices
+        std::vector<int> band_start;        // first entry of every row of tiles in active_list
+
+        long long tiles_evolved = 0; 
+        long long tiles_offered = 0; 
+        long long tiles_stolen = 0; 
+
+        /* Thread k of n owns the rows of tiles from band_begin(k, n) up to band_begin(k + 1, n):
+        place_rows allocates them on its node and evolve_rule queues their tiles for it */
+        int band_begin(int k, int n); 
+
+        // deques of the active tiles, one per thread, see TileScheduler.h
+        TileScheduler scheduler; 
+        std::vector<int> queue_start; 
+
+        void init_tiles(); 
+
+        // Mark the tile of cell (x, y) and its neighbours as active
+        void activate(int x, int y); 
+
+        void activate_tile_and_neighbours(int t); 
+
+        /* Every row of a tile is a segment hashed by the sum of random column weights
+        of its living cells. The world hash is the xor of the hashing::segment keys, so
+        evolve only has to add two weights per cell and swap the keys of segments whose
+        sum changed */
+        std::vector<uint32_t> col_weight; 
+        uint64_t state_hash = 0; 
+
+        uint32_t segment_sum(int x, int block); 
+
+        void rehash(); 
+
+        /* Population and bounding box of every tile. evolve_tile adds births and deaths
+        to the population and rebuilds the box from the cells it writes, skipped tiles
+        keep theirs, so the world totals only need a pass over the tiles */
+        std::vector<Stats> tile_stats; 
+
+        // Counts all tiles from scratch, needed after cells were edited
+        void recount(); 
+
+        // Sets counted from the tiles, births and deaths of the last generation
+        void sum_tiles(long long births, long long deaths); 
+
+        // Counts row i of tile t into its stats and births and deaths against before, both
+        // point at column c0
+        void count_row(int t, int i, const int* now, const int* before, int c0, int c1, long long& births, long long& deaths); 
+
+        Rule rule; 
+
+        /* On a torus the border holds copies of the opposite edges instead of zeros,
+        filled by fill_halo before every generation, so the kernels read it the same way */
+        bool torus = false; 
+
+        // Copies the edge rows and columns of state1 into its border
+        void fill_halo(); 
+
+        // Evolve one tile from state1 into state2, returns true if a cell changed and
+        // updates the hash h for every segment that changed and the tile counts
+        template <class R> 
+        bool evolve_tile(int t, uint64_t& h, long long& births, long long& deaths, const R& r); 
+
+        template <class R> 
+        void evolve_rule(const R& r); 
+
+        /* Temporal blocking: a block of block_h x tile_w cells is copied into a scratch
+        buffer together with a halo of k cells, evolved k generations there while the
+        valid region shrinks by one cell per generation, and only then written to state2.
+        Blocks overlap in their halos, so they are independent and run in parallel. On a
+        torus the halo is copied around the edges */
+        int block_depth = 1; 
+
+        template <class R> 
+        void evolve_blocked(int k, const R& r); 
+
+        // Runs the kernels on rule policy r, see Rule.h
+        template <class R> 
+        void advance_rule(int generations, const R& r); 
+
+        // advance_rule on FixedRule<Birth, Survive> if that is the current rule
+        template <uint32_t Birth, uint32_t Survive> 
+        bool advance_fixed(int generations); 
         
     
     public: 
+
+        static const int tile_h = 16; 
+        static const int tile_w = 256; 
+        static const int block_h = 64; 
+        static const int max_block_depth = 32; 
        
         World();
         World(int height, int width);
         World(std::string f_path);
 
-        int get_height(); 
+        const char* name() override { return "world"; }
+
+        int get_height() override; 
+
+        int get_width() override; 
+
+        void evolve() override; 
 
-        int get_width(); 
+        // Evolves block_depth generations per pass over memory where possible
+        void advance(int generations) override; 
 
-        int world_size(); 
+        // Generations per temporal block, 1 evolves one generation at a time
+        void set_block_depth(int k); 
 
-        void evolve(); 
+        int get_block_depth(); 
 
-        bool is_stable(); 
+        void set_rule(const Rule& rule) override; 
 
-        void print(); 
+        void set_torus(bool torus) override; 
+
+        uint64_t hash() override; 
+
+        size_t memory() override; 
 
         void load(std::string f_path); 
 
-        void save(); 
+        void save(std::string f_path = "GameState.txt") override; 
+
+        void pack(uint64_t* rows) override; 
+
+        void unpack(const uint64_t* rows) override; 
 
         // Generates grid with random 0 1 occurences
-        void random(double probability = 0.3); 
+        void random(double probability = 0.3) override; 
+
+        // the index versions of Engine count row-major over the inner grid
+        using Engine::set; 
+        using Engine::get; 
+
+        void set(int x, int y) override; 
+
+        // Fills the run and hashes every touched segment once
+        void set_run(int x, int y, int n) override; 
+
+        int get(int x, int y) override; 
+
+        // Tiles in the dirty set for the next generation
+        int active_tiles(); 
 
-        void set(int x, int y); 
+        int total_tiles(); 
 
-        void set(int index); 
+        // Share of tiles skipped since the world was created
+        double skipped_fraction(); 
 
-        int get(int x, int y); 
+        // Share of the evolved tiles that an idle thread took from another one's band
+        double stolen_fraction(); 
 
-        int get(int index); 
+        /* Reallocates every row of tiles on the thread that evolves it, so first touch
+        puts its pages on that thread's NUMA node. Needed again after the number of
+        threads or their pinning changed */
+        void place_rows(); 
 }; 
 
 #endif
\ No newline at end of file
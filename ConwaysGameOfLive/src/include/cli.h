@@ -1,7 +1,13 @@
 #ifndef CLI_H
 #define CLI_H 
 #include <string>
+#include <memory>
 #include "World.h"
+#include "Engine.h"
+#include "CycleDetector.h"
+#include "Checkpoint.h"
+#include "Renderer.h"
+#include "History.h"
 #include <chrono>
 
 class CLI {
@@ -11,26 +17,101 @@ class CLI {
 public: 
     CLI();
 
-    // Create world given height and width
-    void create(int height, int width); 
+    // Create world given height, width and engine name, on a torus or a bounded plane
+    void create(int height, int width, std::string engine = "world", bool torus = false); 
 
-    // Load world from specified file 
-    void load(std::string f_path); 
+    // Switch the current world to another engine, keeping its cells
+    void engine(std::string name); 
+
+    /* Load world from specified file, a checkpoint resumes at its generation. .rle and
+    .cells patterns are placed into the current world instead, their cell (0, 0) at (x, y) */
+    void load(std::string f_path, int x = 1, int y = 1); 
     
-    // Save current state of the world to a file
-    void save(std::string filename); 
+    /* Save current state of the world to a file, as text, as a bit-packed binary
+    snapshot, raw or run-length encoded, or as a Golly RLE (golly) or plaintext (cells)
+    pattern. Without a format names ending in .snap are saved as rle, .rle as golly,
+    .cells as cells and all others as text */
+    void save(std::string filename, std::string format = ""); 
+
+    /* Checkpoint to a file every so many generations and/or seconds while running,
+    written by a background thread. 0 for both turns checkpoints off. Throws
+    std::runtime_error where keep_history would, checkpoints hold the same bit rows */
+    void checkpoint(std::string f_path, long long generations, double seconds); 
+
+    // File the mapped engine keeps its generations in from now on
+    void map_file(std::string f_path); 
 
     // Enable/disable printing of the world
     void print(int setting);
     
+    /* Cells per screen cell along each side when printing, 0 for the smallest zoom that
+    fits the terminal, with the viewport starting at world cell (top, left) */
+    void zoom(int k, int top = 1, int left = 1); 
+
     // Set delay for printing (in ms)
     void delay(int ms); 
 
+    /* Enable/disable pipelined printing: runs evolve at full speed and a render thread
+    draws the newest generation every delay ms, dropping the ones in between */
+    void pipeline(int setting); 
+
+    // Set the number of threads used by evolve
+    void threads(int n); 
+
+    /* Enable/disable pinning every evolve thread to one CPU, filling a NUMA node before
+    the next. The world engine then moves its rows to the nodes of their threads */
+    void pin(int setting); 
+
+    // Print active tile statistics of the world engine
+    void tiles(); 
+
+    // Set the generations evolved per temporal block by the world engine
+    void block(int k); 
+
+    // Switch to a Life-like rule in B/S notation, e.g. B36/S23
+    void rule(std::string text); 
+
     // Enable/disable stability check
     void stability(int x); 
 
-    // Run for n generations and return execution time
-    double run(int gen); 
+    /* Run for up to gen generations and return execution time, optionally switching
+    engine first. until stops the run early: "empty" once the population is zero,
+    "period" once the world repeats, "grow" once the bounding box got taller or wider
+    than at the start. gen is set to the generations actually run */
+    double run(int& gen, std::string engine = "", std::string until = ""); 
+
+    /* Record every generation run from now on in a delta-compressed history of at most
+    megabytes, with a keyframe every interval generations. 0 megabytes turns it off.
+    Throws std::runtime_error on engines of an unbounded plane and for rules with more
+    than 2 states, the history only holds the living cells of a grid */
+    void keep_history(double megabytes, long long interval); 
+
+    // Go back or forward to a generation kept in the history, the next run goes on from there
+    void go_to(long long target); 
+
+    // Go back n generations
+    void rewind(long long n); 
+
+    // Print population, births, deaths and bounding box of the current generation
+    void stats(); 
+
+    // Name of the current engine
+    std::string engine_name(); 
+
+    // Number of cells of the current world
+    long long world_size(); 
+
+    // Advance by n generations with the hashlife engine, switching to it first if needed.
+    // Refused while the history is on, it would miss the generations jumped over
+    double jump(unsigned long long gen); 
+
+    /* Evolve a batch of 64 or 256 random worlds of height x width until all settled
+    or gen generations passed, print the population and period of every world and
+    return execution time. The current world is left alone */
+    double batch(int lanes, int height, int width, long long gen, double density); 
+
+    // Move the window of the sparse engine to plane cell (row, col)
+    void view(long long row, long long col); 
 
     // Set cell state at (x, y)
     void set(int x, int y, int alive); 
@@ -62,8 +143,33 @@ public:
 private: 
     bool print_world = false; 
     bool check_stability = false; 
+    bool pipelined = false; 
     int print_delay = 100; 
-    World world; 
+    std::unique_ptr<Engine> world; 
+    // applied to every engine the world is created in or converted to
+    Rule current_rule; 
+    // topology chosen at create, kept by engine switches and loads
+    bool torus = false; 
+    long long generation = 0; 
+    // history of generation hashes, cleared whenever cells are edited
+    CycleDetector cycle; 
+    std::unique_ptr<Checkpointer> checkpoints; 
+    std::unique_ptr<History> history; 
+    // keeps the frame on screen so a run only redraws the cells that changed
+    Renderer renderer; 
+
+    // Writes generation, rule and topology into the file header of a mapped world
+    void describe_mapped(); 
+
+    /* Throws std::runtime_error if history or checkpoints are on and engine name runs on
+    an unbounded plane or rule has more than 2 states, both only hold living cells of a grid */
+    void check_recording(const std::string& name, const Rule& rule); 
+
+    // Hands the world to the checkpoint writer if a checkpoint is due
+    void checkpoint_if_due(); 
+
+    // Streams an rle or cells pattern into the current world, taking the rule of an rle header
+    void place(std::string f_path, std::string format, int x, int y); 
 }; 
 
 #endif
\ No newline at end of file
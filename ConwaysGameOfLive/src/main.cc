@@ -1,4 +1,7 @@
 #include "include/cli.h"
+#include "include/Benchmark.h"
+#include "include/DistributedWorld.h"
+#include "include/Numa.h"
 #include <iostream>
 #include <string>
 #include <vector>
@@ -9,12 +12,29 @@
 
 enum commands {
     CREATE, 
+    ENGINE, 
     LOAD, 
     SAVE, 
+    CHECKPOINT, 
+    HISTORY, 
+    MAPFILE, 
+    REWIND, 
+    GOTO, 
     PRINT, 
     DELAY, 
+    ZOOM, 
+    PIPELINE, 
+    THREADS, 
+    PIN, 
+    TILES, 
+    BLOCK, 
+    RULE, 
     STABILITY, 
+    STATS, 
     RUN, 
+    JUMP, 
+    BATCH, 
+    VIEW, 
     SET, 
     GET, 
     GLIDER, 
@@ -49,12 +69,29 @@ std::vector<std::string> split(const std::string& input) {
 // Map command strings to enum values
 std::map<std::string, commands> command_map = {
     {"create", CREATE},
+    {"engine", ENGINE},
     {"load", LOAD},
     {"save", SAVE},
+    {"checkpoint", CHECKPOINT},
+    {"history", HISTORY},
+    {"mapfile", MAPFILE},
+    {"rewind", REWIND},
+    {"goto", GOTO},
     {"print", PRINT},
     {"delay", DELAY},
+    {"zoom", ZOOM},
+    {"pipeline", PIPELINE},
+    {"threads", THREADS},
+    {"pin", PIN},
+    {"tiles", TILES},
+    {"block", BLOCK},
+    {"rule", RULE},
     {"stability", STABILITY},
+    {"stats", STATS},
     {"run", RUN},
+    {"jump", JUMP},
+    {"batch", BATCH},
+    {"view", VIEW},
     {"set", SET},
     {"get", GET},
     {"glider", GLIDER},
@@ -66,7 +103,31 @@ std::map<std::string, commands> command_map = {
     {".exit", EXIT}
 };
 
-int main() {
+int main(int argc, char** argv) {
+    // under mpirun only rank 0 reads commands, the other ranks evolve their blocks
+    distributed::Session session(argc, argv);
+    if (!session.is_root()) {
+        session.serve();
+        return 0;
+    }
+
+    if (argc > 1) {
+        // flags select the headless benchmark instead of the prompt
+        std::string flag = argv[1];
+        if (flag != "--bench") {
+            Benchmark::usage(flag == "--help" ? std::cout : std::cerr);
+            return flag == "--help" ? 0 : 1;
+        }
+        try {
+            Benchmark benchmark(argc, argv);
+            return benchmark.run();
+        } catch (const std::exception& e) {
+            std::cerr << "Error: " << e.what() << std::endl;
+            Benchmark::usage(std::cerr);
+            return 1;
+        }
+    }
+
     CLI cli;
     std::string input_str;
 
@@ -74,7 +135,9 @@ int main() {
 
     while (true) {
         std::cout << "> ";
-        std::getline(std::cin, input_str);
+        if (!std::getline(std::cin, input_str)) {
+            break; // end of input
+        }
         input_str = trim(input_str);
 
         if (input_str.empty()) {
@@ -99,34 +162,108 @@ int main() {
         try {
             switch (cmd) {
                 case CREATE: {
-                    if (tokens.size() != 3) {
-                        throw std::runtime_error("Usage: create <height> <width>");
+                    // the topology may follow the size or the engine
+                    bool torus = tokens.back() == "torus";
+                    size_t n = tokens.size() - (torus || tokens.back() == "plane" ? 1 : 0);
+                    if (n != 3 && n != 4) {
+                        throw std::runtime_error("Usage: create <height> <width> [engine] [torus|plane]");
                     }
                     int height = std::stoi(tokens[1]);
                     int width = std::stoi(tokens[2]);
                     if (height <= 0 || width <= 0) {
                         throw std::runtime_error("Height and width must be positive");
                     }
-                    cli.create(height, width);
-                    std::cout << "Created " << height << "x" << width << " world" << std::endl;
+                    std::string engine = n == 4 ? tokens[3] : "world";
+                    cli.create(height, width, engine, torus);
+                    std::cout << "Created " << height << "x" << width << " " << engine << " world"
+                              << (torus ? " on a torus" : "") << std::endl;
                     break;
                 }
-                case LOAD: {
+                case ENGINE: {
                     if (tokens.size() != 2) {
-                        throw std::runtime_error("Usage: load <filename>");
+                        throw std::runtime_error("Usage: engine <name>");
+                    }
+                    cli.engine(tokens[1]);
+                    std::cout << "Switched to " << tokens[1] << " engine" << std::endl;
+                    break;
+                }
+                case LOAD: {
+                    if (tokens.size() != 2 && tokens.size() != 4) {
+                        throw std::runtime_error("Usage: load <filename> [x y]");
+                    }
+                    if (tokens.size() == 4) {
+                        cli.load(tokens[1], std::stoi(tokens[2]), std::stoi(tokens[3]));
+                    } else {
+                        cli.load(tokens[1]);
                     }
-                    cli.load(tokens[1]);
                     std::cout << "Loaded world from " << tokens[1] << std::endl;
                     break;
                 }
                 case SAVE: {
-                    if (tokens.size() != 2) {
-                        throw std::runtime_error("Usage: save <filename>");
+                    if (tokens.size() != 2 && tokens.size() != 3) {
+                        throw std::runtime_error("Usage: save <filename> [text|binary|rle|golly|cells]");
                     }
-                    cli.save(tokens[1]);
+                    cli.save(tokens[1], tokens.size() == 3 ? tokens[2] : "");
                     std::cout << "Saved world to " << tokens[1] << std::endl;
                     break;
                 }
+                case CHECKPOINT: {
+                    if (tokens.size() == 2 && tokens[1] == "off") {
+                        cli.checkpoint("", 0, 0);
+                        std::cout << "Checkpoints off" << std::endl;
+                        break;
+                    }
+                    if (tokens.size() != 3 && tokens.size() != 4) {
+                        throw std::runtime_error("Usage: checkpoint <filename> <generations> [seconds] | checkpoint off");
+                    }
+                    long long generations = std::stoll(tokens[2]);
+                    double seconds = tokens.size() == 4 ? std::stod(tokens[3]) : 0;
+                    cli.checkpoint(tokens[1], generations, seconds);
+                    std::cout << "Checkpoints to " << tokens[1] << " every " << generations << " generations";
+                    if (seconds > 0) {
+                        std::cout << " or " << seconds << " seconds";
+                    }
+                    std::cout << std::endl;
+                    break;
+                }
+                case HISTORY: {
+                    if (tokens.size() == 2 && tokens[1] == "off") {
+                        cli.keep_history(0, 1);
+                        std::cout << "History off" << std::endl;
+                        break;
+                    }
+                    if (tokens.size() != 2 && tokens.size() != 3) {
+                        throw std::runtime_error("Usage: history <megabytes> [keyframe interval] | history off");
+                    }
+                    double megabytes = std::stod(tokens[1]);
+                    long long interval = tokens.size() == 3 ? std::stoll(tokens[2]) : 64;
+                    cli.keep_history(megabytes, interval);
+                    std::cout << "Keeping up to " << megabytes << " MB of history, a keyframe every "
+                              << interval << " generations" << std::endl;
+                    break;
+                }
+                case MAPFILE: {
+                    if (tokens.size() != 2) {
+                        throw std::runtime_error("Usage: mapfile <filename>");
+                    }
+                    cli.map_file(tokens[1]);
+                    std::cout << "The mapped engine keeps its world in " << tokens[1] << std::endl;
+                    break;
+                }
+                case REWIND: {
+                    if (tokens.size() != 2) {
+                        throw std::runtime_error("Usage: rewind <generations>");
+                    }
+                    cli.rewind(std::stoll(tokens[1]));
+                    break;
+                }
+                case GOTO: {
+                    if (tokens.size() != 2) {
+                        throw std::runtime_error("Usage: goto <generation>");
+                    }
+                    cli.go_to(std::stoll(tokens[1]));
+                    break;
+                }
                 case PRINT: {
                     if (tokens.size() != 2) {
                         throw std::runtime_error("Usage: print <0|1>");
@@ -139,6 +276,31 @@ int main() {
                     std::cout << "Print setting: " << (setting ? "enabled" : "disabled") << std::endl;
                     break;
                 }
+                case ZOOM: {
+                    if (tokens.size() != 2 && tokens.size() != 4) {
+                        throw std::runtime_error("Usage: zoom <k|auto> [top left]");
+                    }
+                    int k = tokens[1] == "auto" ? 0 : std::stoi(tokens[1]);
+                    if (tokens.size() == 4) {
+                        cli.zoom(k, std::stoi(tokens[2]), std::stoi(tokens[3]));
+                    } else {
+                        cli.zoom(k);
+                    }
+                    std::cout << "Zoom " << (k == 0 ? std::string("auto") : std::to_string(k)) << std::endl;
+                    break;
+                }
+                case PIPELINE: {
+                    if (tokens.size() != 2) {
+                        throw std::runtime_error("Usage: pipeline <0|1>");
+                    }
+                    int setting = std::stoi(tokens[1]);
+                    if (setting != 0 && setting != 1) {
+                        throw std::runtime_error("Setting must be 0 or 1");
+                    }
+                    cli.pipeline(setting);
+                    std::cout << "Pipeline setting: " << (setting ? "enabled" : "disabled") << std::endl;
+                    break;
+                }
                 case DELAY: {
                     if (tokens.size() != 2) {
                         throw std::runtime_error("Usage: delay <ms>");
@@ -151,6 +313,54 @@ int main() {
                     std::cout << "Set delay to " << ms << " ms" << std::endl;
                     break;
                 }
+                case THREADS: {
+                    if (tokens.size() != 2) {
+                        throw std::runtime_error("Usage: threads <n>");
+                    }
+                    int n = std::stoi(tokens[1]);
+                    if (n <= 0) {
+                        throw std::runtime_error("Number of threads must be positive");
+                    }
+                    cli.threads(n);
+                    std::cout << "Evolving with " << n << " threads" << std::endl;
+                    break;
+                }
+                case PIN: {
+                    if (tokens.size() != 2) {
+                        throw std::runtime_error("Usage: pin <0|1>");
+                    }
+                    int setting = std::stoi(tokens[1]);
+                    if (setting != 0 && setting != 1) {
+                        throw std::runtime_error("Setting must be 0 or 1");
+                    }
+                    cli.pin(setting);
+                    std::cout << "Pinning setting: " << (setting ? "enabled" : "disabled") << " ("
+                              << numa::cpus().size() << " CPUs on " << numa::nodes() << " NUMA nodes)" << std::endl;
+                    break;
+                }
+                case TILES: {
+                    if (tokens.size() != 1) {
+                        throw std::runtime_error("Usage: tiles");
+                    }
+                    cli.tiles();
+                    break;
+                }
+                case BLOCK: {
+                    if (tokens.size() != 2) {
+                        throw std::runtime_error("Usage: block <generations>");
+                    }
+                    int k = std::stoi(tokens[1]);
+                    cli.block(k);
+                    std::cout << "Evolving " << k << " generations per block" << std::endl;
+                    break;
+                }
+                case RULE: {
+                    if (tokens.size() != 2) {
+                        throw std::runtime_error("Usage: rule <Bxx/Syy>");
+                    }
+                    cli.rule(tokens[1]);
+                    break;
+                }
                 case STABILITY: {
                     if (tokens.size() != 2) {
                         throw std::runtime_error("Usage: stability <0|1>");
@@ -163,16 +373,79 @@ int main() {
                     std::cout << "Stability check: " << (setting ? "enabled" : "disabled") << std::endl;
                     break;
                 }
+                case STATS: {
+                    if (tokens.size() != 1) {
+                        throw std::runtime_error("Usage: stats");
+                    }
+                    cli.stats();
+                    break;
+                }
                 case RUN: {
-                    if (tokens.size() != 2) {
-                        throw std::runtime_error("Usage: run <generations>");
+                    // run <generations> [engine] [until <condition>]
+                    size_t until = std::find(tokens.begin(), tokens.end(), "until") - tokens.begin();
+                    if (tokens.size() < 2 || until < 2 || until > 3 || (until < tokens.size() && until + 2 != tokens.size())) {
+                        throw std::runtime_error("Usage: run <generations> [engine] [until <empty|period|grow>]");
                     }
                     int gen = std::stoi(tokens[1]);
                     if (gen < 0) {
                         throw std::runtime_error("Generations must be non-negative");
                     }
-                    double time = cli.run(gen);
-                    std::cout << "Ran " << gen << " generations in " << time << " seconds" << std::endl;
+                    double time = cli.run(gen, until == 3 ? tokens[2] : "", until < tokens.size() ? tokens[until + 1] : "");
+                    std::cout << "Ran " << gen << " generations in " << time << " seconds";
+                    if (time > 0) {
+                        std::cout << " (" << gen * cli.world_size() / time << " cells/s, " << cli.engine_name() << " engine)";
+                    }
+                    std::cout << std::endl;
+                    break;
+                }
+                case JUMP: {
+                    if (tokens.size() != 2) {
+                        throw std::runtime_error("Usage: jump <generations> or jump 2^<k>");
+                    }
+                    unsigned long long gen;
+                    if (tokens[1].compare(0, 2, "2^") == 0) {
+                        int k = std::stoi(tokens[1].substr(2));
+                        if (k < 0 || k > 62) {
+                            throw std::runtime_error("Exponent must be between 0 and 62");
+                        }
+                        gen = 1ULL << k;
+                    } else {
+                        if (tokens[1][0] == '-') {
+                            throw std::runtime_error("Generations must be non-negative");
+                        }
+                        gen = std::stoull(tokens[1]);
+                    }
+                    double time = cli.jump(gen);
+                    std::cout << "Jumped " << gen << " generations in " << time << " seconds" << std::endl;
+                    break;
+                }
+                case BATCH: {
+                    if (tokens.size() < 4 || tokens.size() > 6) {
+                        throw std::runtime_error("Usage: batch <64|256> <height> <width> [generations] [density]");
+                    }
+                    int lanes = std::stoi(tokens[1]);
+                    int height = std::stoi(tokens[2]);
+                    int width = std::stoi(tokens[3]);
+                    long long gen = tokens.size() > 4 ? std::stoll(tokens[4]) : 10000;
+                    double density = tokens.size() > 5 ? std::stod(tokens[5]) : 0.3;
+                    if (height <= 0 || width <= 0 || gen < 0) {
+                        throw std::runtime_error("Height and width must be positive, generations non-negative");
+                    }
+                    if (density < 0 || density > 1) {
+                        throw std::runtime_error("Density must be between 0 and 1");
+                    }
+                    double time = cli.batch(lanes, height, width, gen, density);
+                    std::cout << "Ran " << lanes << " worlds in " << time << " seconds" << std::endl;
+                    break;
+                }
+                case VIEW: {
+                    if (tokens.size() != 3) {
+                        throw std::runtime_error("Usage: view <row> <col>");
+                    }
+                    long long row = std::stoll(tokens[1]);
+                    long long col = std::stoll(tokens[2]);
+                    cli.view(row, col);
+                    std::cout << "Window starts at plane cell (" << row << ", " << col << ")" << std::endl;
                     break;
                 }
                 case SET: {
@@ -285,13 +558,37 @@ int main() {
                 }
                 case HELP: {
                     std::cout << "Available commands:\n"
-                              << "  create <height> <width> : Create a new world\n"
-                              << "  load <filename> : Load world from file\n"
-                              << "  save <filename> : Save world to file\n"
+                              << "  create <height> <width> [engine] [torus|plane] : Create a new world (engines: world, packed, table, byte, generations, hashlife, sparse, mapped, distributed),\n"
+                              << "      torus wraps the edges around (world and distributed engines)\n"
+                              << "  engine <name> : Switch the current world to another engine\n"
+                              << "  load <filename> [x y] : Load world from file, a checkpoint resumes at its generation,\n"
+                              << "    .rle and .cells patterns are placed into the current world at x y (default 1 1)\n"
+                              << "  save <filename> [text|binary|rle|golly|cells] : Save world to file, .snap files default\n"
+                              << "    to rle, .rle to golly and .cells to cells patterns\n"
+                              << "  checkpoint <filename> <generations> [seconds] : Checkpoint in the background while running, off to stop\n"
+                              << "  history <megabytes> [interval] : Keep the generations run as keyframes and deltas, off to stop\n"
+                              << "    (bounded engines and 2-state rules only, jump is refused)\n"
+                              << "  mapfile <filename> : File of the mapped engine, GameState.map by default\n"
+                              << "  rewind <generations> : Go back in the history\n"
+                              << "  goto <generation> : Go to a generation kept in the history\n"
                               << "  print <0|1> : Enable/disable printing\n"
+                              << "  zoom <k|auto> [top left] : Print k x k cells per screen cell as their density,\n"
+                              << "    auto fits the world to the terminal, the viewport starts at cell top left\n"
                               << "  delay <ms> : Set print delay in milliseconds\n"
+                              << "  pipeline <0|1> : Draw on a render thread every delay ms while run evolves at full speed\n"
+                              << "  threads <n> : Set number of threads used to evolve\n"
+                              << "  pin <0|1> : Pin every evolve thread to one CPU, node by node (world rows move along)\n"
+                              << "  tiles : Show active tile statistics (world engine)\n"
+                              << "  block <generations> : Generations evolved per cache block (world engine, 1 disables blocking)\n"
+                              << "  rule <Bxx/Syy> : Life-like rule, e.g. B36/S23 or highlife, daynight, seeds (world and table engines),\n"
+                              << "    Generations rule, e.g. B2/S/C3 or brianbrain, starwars (generations engine)\n"
                               << "  stability <0|1> : Enable/disable stability check\n"
-                              << "  run <generations> : Run simulation for n generations\n"
+                              << "  stats : Show population, births, deaths and bounding box\n"
+                              << "  run <generations> [engine] [until <empty|period|grow>] : Run simulation for n generations, optionally on\n"
+                              << "    another engine, until the population is zero, the world repeats or its bounding box grows\n"
+                              << "  jump <generations|2^k> : Advance with the hashlife engine\n"
+                              << "  batch <64|256> <height> <width> [generations] [density] : Run 64 or 256 random worlds at once until they settle\n"
+                              << "  view <row> <col> : Move the window of the sparse engine\n"
                               << "  set <x> <y> <0|1> : Set cell state at (x, y)\n"
                               << "  set <index> <0|1> : Set cell state at index\n"
                               << "  get <x> <y> : Get cell state at (x, y)\n"